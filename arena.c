@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include "arena.h"
+#include "gc.h"
+#include "errors.h"
+
+#define ARENA_ALIGN 16 // staci pro vsechny zakladni typy
+#define ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct arena_block {
+	struct arena_block* next; // predchozi (plny) blok
+	size_t size;
+	size_t used;
+	union { // zarovnani dat
+		long double ld;
+		void* p;
+		long long ll;
+	} data[];
+};
+
+void arena_init(struct arena* a, size_t block_size) {
+	a->head = NULL;
+	a->block_size = block_size;
+	a->used = 0;
+}
+
+static struct arena_block* arena_new_block(size_t size) {
+	struct arena_block* block = gc_malloc((int)(sizeof(struct arena_block) + size));
+	if (!block) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate arena block");
+	}
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+void* arena_alloc(struct arena* a, size_t size) {
+	struct arena_block* block = a->head;
+	size = ALIGN_UP(size);
+
+	if (!block || block->used + size > block->size) {
+		if (size > a->block_size / 4) {
+			// velky objekt dostane vlastni blok a aktualni blok zustava rozdelany
+			block = arena_new_block(size);
+			if (a->head) {
+				block->next = a->head->next;
+				a->head->next = block;
+			} else {
+				block->next = NULL;
+				a->head = block;
+			}
+		} else {
+			block = arena_new_block(a->block_size);
+			block->next = a->head;
+			a->head = block;
+		}
+	}
+
+	void* result = (char*)block->data + block->used;
+	block->used += size;
+	a->used += size;
+	return result;
+}
+
+void arena_release(struct arena* a) {
+	struct arena_block* block = a->head;
+	while (block) {
+		struct arena_block* next = block->next;
+		free(block);
+		block = next;
+	}
+	a->head = NULL;
+	a->used = 0;
+}
+
+void arena_reset(struct arena* a) {
+	if (!a->head) {
+		return;
+	}
+
+	struct arena_block* block = a->head->next;
+	while (block) {
+		struct arena_block* next = block->next;
+		free(block);
+		block = next;
+	}
+	a->head->next = NULL;
+	a->head->used = 0;
+	a->used = 0;
+}
+
+void arena_merge(struct arena* a, struct arena* from) {
+	struct arena_block* last = from->head;
+	if (!last) {
+		return;
+	}
+	while (last->next) {
+		last = last->next;
+	}
+
+	// prevzate bloky jdou za aktualni blok, do ktereho se dal alokuje
+	if (a->head) {
+		last->next = a->head->next;
+		a->head->next = from->head;
+	} else {
+		a->head = from->head;
+	}
+	a->used += from->used;
+
+	from->head = NULL;
+	from->used = 0;
+}
@@ -0,0 +1,22 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Arena - alokace posouvanim ukazatele ve velkych blocich, uvolnuje se
+// jen vsechno najednou. Po sobe alokovane objekty lezi v pameti vedle sebe.
+struct arena_block;
+
+struct arena {
+	struct arena_block* head; // blok, do ktereho se prave alokuje
+	size_t block_size; // velikost noveho bloku
+	size_t used; // soucet alokovanych bajtu (pro statistiky)
+};
+
+void arena_init(struct arena* a, size_t block_size);
+void* arena_alloc(struct arena* a, size_t size);
+void arena_release(struct arena* a); // uvolni vsechny bloky, arenu lze pouzit znovu
+void arena_reset(struct arena* a); // zahodi obsah, aktualni blok si necha pro dalsi alokace
+void arena_merge(struct arena* a, struct arena* from); // bloky z from prejdou do a, from zustane prazdna
+
+#endif
@@ -1,34 +1,149 @@
 #include "ast.h"
+#include "arena.h"
+#include "flat.h"
 #include <stdlib.h>
+#include <string.h>
+
+#define AST_ARENA_BLOCK (64 * 1024)
+#define AST_LIST_INITIAL 4
+
+// vsechny uzly a seznamy jedne kompilace, v pameti jdou v poradi parsovani
+static __thread struct arena ast_arena = { NULL, AST_ARENA_BLOCK, 0 };
+static __thread long ast_nodes = 0; // pocet uzlu od posledniho ast_release
+static __thread long ast_leaves = 0; // z toho listu bez left/right
+
+// docasne uzly jednoho tela funkce (--stream)
+static __thread struct arena scratch_arena = { NULL, AST_ARENA_BLOCK, 0 };
+static __thread bool scratch = false;
+static __thread long saved_nodes, saved_leaves;
+
+#define NODE_ARENA (scratch ? &scratch_arena : &ast_arena)
 
 struct ast_node* ast_create_node()
 {
-    struct ast_node* node = (struct ast_node*) malloc(sizeof(struct ast_node));
-    node->left = NULL;
-    node->right = NULL;
+    struct ast_node* node = (struct ast_node*) arena_alloc(NODE_ARENA, sizeof(struct ast_node));
+    memset(node, 0, sizeof(struct ast_node));
+    node->index = FLAT_NONE;
+    ast_nodes++;
+
+    return node;
+}
+
+struct ast_node* ast_create_leaf()
+{
+    struct ast_node* node = (struct ast_node*) arena_alloc(NODE_ARENA, AST_LEAF_SIZE);
+    memset(node, 0, AST_LEAF_SIZE);
+    node->leaf = 1;
+    node->index = FLAT_NONE;
+    ast_nodes++;
+    ast_leaves++;
 
     return node;
 }
 
 struct ast_list* ast_create_list()
 {
-    struct ast_list* list = (struct ast_list*) malloc(sizeof(struct ast_list));
-    list->next = NULL;
-    list->elem = NULL;
+    struct ast_list* list = (struct ast_list*) arena_alloc(NODE_ARENA, sizeof(struct ast_list));
+    list->elems = NULL;
+    list->count = 0;
+    list->capacity = 0;
 
     return list;
 }
 
+size_t ast_memory_used()
+{
+    return ast_arena.used;
+}
+
+long ast_node_count()
+{
+    return ast_nodes;
+}
+
+long ast_leaf_count()
+{
+    return ast_leaves;
+}
+
+string* ast_create_string(const char* txt, int len)
+{
+    if (!scratch) {
+        return new_str_len(txt, len);
+    }
+
+    // literal se stejne zahodi, nema smysl ho mallocovat
+    string* s = arena_alloc(&scratch_arena, sizeof(string));
+    s->str = arena_alloc(&scratch_arena, len + 1);
+    memcpy(s->str, txt, len);
+    s->str[len] = '\0';
+    s->len = len;
+    s->alloc_size = len + 1;
+
+    return s;
+}
+
+void ast_scratch_begin()
+{
+    scratch = true;
+    saved_nodes = ast_nodes;
+    saved_leaves = ast_leaves;
+}
+
+void ast_scratch_end()
+{
+    if (!scratch) {
+        return;
+    }
+    scratch = false;
+    ast_nodes = saved_nodes;
+    ast_leaves = saved_leaves;
+    arena_reset(&scratch_arena);
+}
+
+void ast_detach(struct ast_memory* memory)
+{
+    // docasna arena vlakna se neodevzdava
+    ast_scratch_end();
+    arena_release(&scratch_arena);
+
+    memory->arena = ast_arena;
+    memory->nodes = ast_nodes;
+    memory->leaves = ast_leaves;
+    arena_init(&ast_arena, AST_ARENA_BLOCK);
+    ast_nodes = ast_leaves = 0;
+}
+
+void ast_attach(struct ast_memory* memory)
+{
+    arena_merge(&ast_arena, &memory->arena);
+    ast_nodes += memory->nodes;
+    ast_leaves += memory->leaves;
+    memory->nodes = memory->leaves = 0;
+}
+
+void ast_release()
+{
+    arena_release(&ast_arena);
+    ast_nodes = ast_leaves = 0;
+}
+
 bool ast_list_insert(struct ast_list* l, struct ast_node* n) {
-    if (l->elem == NULL) {
-        l->elem = n;
-    } else {
-        while(l->next != NULL) {
-            l = l->next;
+    if (l->count == l->capacity) {
+        // zdvojnasobeni, stare pole zustane v arene
+        int capacity = (l->capacity) ? l->capacity * 2 : AST_LIST_INITIAL;
+        struct ast_node** elems = arena_alloc(NODE_ARENA, capacity * sizeof(struct ast_node*));
+        if (l->count) {
+            memcpy(elems, l->elems, l->count * sizeof(struct ast_node*));
         }
-        l->next = ast_create_list();
-        l->next->elem = n;
+        l->elems = elems;
+        l->capacity = capacity;
     }
 
+    l->elems[l->count++] = n;
     return true;
 }
+
+struct ast_node* ast_list_at(struct ast_list* l, int i) {
+    return (i >= 0 && i < l->count) ? l->elems[i] : NULL;
+}
@@ -3,14 +3,38 @@
 #define AST_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "string.h"
 #include "common.h"
+#include "arena.h"
 
 struct ast_node* ast_create_node();
+struct ast_node* ast_create_leaf(); // uzel bez left/right, viz struct ast_node
 struct ast_list* ast_create_list();
+size_t ast_memory_used(); // bajty v arene stromu
+long ast_node_count();
+long ast_leaf_count(); // z ast_node_count
+void ast_release(); // uvolni cely strom najednou, uzly uz se nesmi pouzit
+string* ast_create_string(const char* txt, int len); // retezcovy literal
+
+// docasne uzly (--stream): mezi begin a end jde vsechno do zvlastni areny,
+// kterou end zase vyprazdni; do pocitadel uzlu se nezapocitaji
+void ast_scratch_begin();
+void ast_scratch_end(); // mimo begin nic nedela (i po chybe)
+
+// kazde vlakno alokuje do sve areny; strom postaveny v jinem vlakne
+// (--parallel) se odevzda pres ast_detach a prevezme pres ast_attach
+struct ast_memory {
+    struct arena arena;
+    long nodes;
+    long leaves;
+};
+void ast_detach(struct ast_memory* memory); // pamet vlakna do memory, vlakno zacina znovu
+void ast_attach(struct ast_memory* memory); // pamet z memory do tohoto vlakna
 
 bool ast_list_insert(struct ast_list* l, struct ast_node* n);
-struct ast_list* ast_list_get_last(struct ast_list* l);
+struct ast_node* ast_list_at(struct ast_list* l, int i); // NULL mimo rozsah
 void ast_list_print(struct ast_list* l);
 void ast_node_print(struct ast_node* n);
 
@@ -46,6 +70,7 @@ enum ast_node_type
     AST_FUNCTION_ARGUMENTS,
     AST_BODY,
     AST_BLOCK,
+    AST_LAZY_BODY, // telo funkce zatim neparsovane (--lazy), d.offset je jeho '{'
 };
 
 enum ast_literal_type
@@ -80,27 +105,38 @@ union ast_node_data
     struct ast_node* condition; //pro podminku u if
     struct ast_list* list; // pro uchovavani agumentu, statement body, function body, if body, else body..
     bool bool_data;
+    int offset; // pozice ve zdrojovem textu
 };
 
 // po libosti upravujte, kdyz vam neco nesedi!
+// Hlavicka ma 16 bajtu (typy po jednom bajtu, index, data - literal je
+// primo v d), vnitrni uzel k ni pridava left a right. Listy ve vyrazech
+// (literaly, promenne) se alokuji pres ast_create_leaf jen v delce
+// hlavicky - jejich left/right se nesmi cist ani zapisovat (poznat je
+// podle leaf). Novy uzel je vynulovany.
 struct ast_node
 {
-    enum ast_node_type type;
+    uint8_t type; // enum ast_node_type
+    uint8_t var_type; // enum ast_var_type
+    uint8_t literal; // enum ast_literal_type, typ konstanty; u AST_BINARY_OP znacka typove kontroly (typecheck.h)
+    uint8_t leaf; // 1 = z ast_create_leaf, nema left/right
+    int32_t index; // koren vyrazu v ploche reprezentaci (flat.h), FLAT_NONE = neprevedeno;
+                   // u AST_VAR slot promenne a u AST_FUNCTION velikost ramce (resolver.h)
 
     union ast_node_data d;
 
-    enum ast_var_type var_type;
-    enum ast_literal_type literal; // typ konstanty
-
     struct ast_node* left;
     struct ast_node* right;
 };
 
-// seznam instrukci
+#define AST_LEAF_SIZE offsetof(struct ast_node, left)
+
+// seznam instrukci - souvisle pole v arene, prochazi se indexem
 struct ast_list
 {
-    struct ast_node* elem;
-    struct ast_list* next;
+    struct ast_node** elems;
+    int count;
+    int capacity;
 };
 
 #endif
@@ -0,0 +1,39 @@
+#! /bin/bash
+
+# mereni rychlosti lexeru (tokeny/s) nad programy v programs/
+# pouziti: ./bench.sh [velikost korpusu v MB] [pocet behu]
+
+size_mb=${1:-16}
+runs=${2:-3}
+
+bench_bin=$(mktemp)
+corpus=$(mktemp)
+part=$(mktemp)
+trap "rm -f $bench_bin $corpus $part" EXIT
+
+# samostatny build s optimalizacemi, release zustava netknuty
+gcc -std=c99 -O2 *.c -o $bench_bin -lm -lpthread &> /dev/null
+if [[ $? -ne 0 ]]; then
+    echo "cannot build the lexer benchmark"
+    exit 1
+fi
+
+# do korpusu jdou jen soubory, ktere projdou lexerem bez chyby
+for file in programs/*.ifj; do
+    if $bench_bin --bench-lex 1 "$file" &> /dev/null; then
+        cat "$file" >> $part
+        echo "" >> $part
+    fi
+done
+
+if [[ ! -s $part ]]; then
+    echo "no lexically valid programs found"
+    exit 1
+fi
+
+while [[ $(stat -c %s $corpus) -lt $((size_mb * 1024 * 1024)) ]]; do
+    cat $part >> $corpus
+done
+
+echo "corpus: $(stat -c %s $corpus) bytes"
+$bench_bin --bench-lex $runs $corpus
@@ -0,0 +1,526 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cache.h"
+#include "input.h"
+#include "intern.h"
+#include "flat.h"
+
+#ifndef _WIN32 // bez mmap se cache nacte jednim fread
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#define CACHE_SUFFIX ".ifjc"
+#define CACHE_VERSION 2 // zvysit pri kazde zmene ast_node, parseru nebo tohoto formatu
+#define CACHE_NONE (-1) // chybejici potomek
+
+// Soubor: hlavicka, pole uzlu, polozky seznamu (indexy uzlu) a retezce
+// (delka + znaky). Uzly jsou ocislovane do sirky od korene (index 0),
+// ukazatele se ukladaji jako indexy.
+struct cache_header {
+    char magic[4]; // "IFJC"
+    uint32_t version;
+    uint64_t source_hash;
+    uint64_t source_size;
+    uint32_t node_count;
+    uint32_t elem_count;
+    uint32_t text_size;
+    uint32_t reserved;
+};
+
+struct cache_node {
+    uint32_t payload[2]; // d podle typu uzlu, viz node_payload
+    int32_t left;
+    int32_t right;
+    uint8_t type;
+    uint8_t var_type;
+    uint8_t literal;
+    uint8_t leaf;
+};
+
+// co je v union ast_node_data
+enum cache_payload {
+    PAYLOAD_RAW, // cislo, operator, bool - bajty tak jak jsou
+    PAYLOAD_NAME, // internovany nazev promenne/funkce, offset do retezcu (kazdy nazev jen jednou)
+    PAYLOAD_TEXT, // retezcovy literal, offset do retezcu
+    PAYLOAD_LIST, // prvni polozka, pocet
+    PAYLOAD_CONDITION // index uzlu
+};
+
+static enum cache_payload node_payload(uint8_t type, uint8_t literal) {
+    switch (type) {
+        case AST_LITERAL:
+            return (literal == AST_LITERAL_STRING) ? PAYLOAD_TEXT : PAYLOAD_RAW;
+        case AST_VAR:
+        case AST_CALL:
+        case AST_FUNCTION:
+            return PAYLOAD_NAME;
+        case AST_IF:
+            return PAYLOAD_CONDITION;
+        case AST_FUNCTION_LIST:
+        case AST_FUNCTION_ARGUMENTS:
+        case AST_BODY:
+        case AST_BLOCK:
+        case AST_COUT:
+        case AST_CIN:
+        case AST_FOR:
+            return PAYLOAD_LIST;
+        default:
+            return PAYLOAD_RAW;
+    }
+}
+
+static uint64_t source_hash() {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a 64
+    for (const unsigned char* p = input_start; p < input_end; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static char* cache_path(const char* source_file) {
+    size_t len = strlen(source_file);
+    char* path = malloc(len + sizeof(CACHE_SUFFIX ".tmp"));
+    if (path) {
+        memcpy(path, source_file, len);
+        strcpy(path + len, CACHE_SUFFIX);
+    }
+    return path;
+}
+
+// --- ukladani ---
+
+struct cache_writer {
+    struct ast_node** nodes; // poradi ve fronte = index v souboru
+    struct cache_node* records;
+    int32_t* elems;
+    char* text;
+    uint32_t node_count, node_size;
+    uint32_t elem_count, elem_size;
+    uint32_t text_size, text_capacity;
+    // uz zapsane nazvy: internovany ukazatel -> offset (otevrene adresovani)
+    string** names;
+    uint32_t* name_offsets;
+    uint32_t name_count, name_size;
+    bool failed;
+};
+
+static bool writer_grow(void** array, uint32_t* size, uint32_t needed, size_t item) {
+    if (needed <= *size) {
+        return true;
+    }
+    uint32_t size_new = (*size) ? *size : 256;
+    while (size_new < needed) {
+        size_new *= 2;
+    }
+    void* array_new = realloc(*array, size_new * item);
+    if (!array_new) {
+        return false;
+    }
+    *array = array_new;
+    *size = size_new;
+    return true;
+}
+
+// index uzlu v souboru; uzel jeste nevideny se zaradi do fronty a docasne
+// si index pamatuje v node->index (pred interpretaci je tam FLAT_NONE)
+static int32_t writer_node(struct cache_writer* w, struct ast_node* node) {
+    if (node == NULL) {
+        return CACHE_NONE;
+    }
+    if (node->index == FLAT_NONE) {
+        if (!writer_grow((void**)&w->nodes, &w->node_size, w->node_count + 1, sizeof(struct ast_node*))) {
+            w->failed = true;
+            return CACHE_NONE;
+        }
+        node->index = (int32_t)w->node_count;
+        w->nodes[w->node_count++] = node;
+    }
+    return node->index;
+}
+
+static uint32_t writer_text(struct cache_writer* w, string* s) {
+    uint32_t len = (s) ? (uint32_t)s->len : 0;
+    uint32_t offset = w->text_size;
+    if (!writer_grow((void**)&w->text, &w->text_capacity, offset + sizeof(uint32_t) + len, 1)) {
+        w->failed = true;
+        return 0;
+    }
+    memcpy(w->text + offset, &len, sizeof(uint32_t));
+    if (len) {
+        memcpy(w->text + offset + sizeof(uint32_t), s->str, len);
+    }
+    w->text_size += sizeof(uint32_t) + len;
+    return offset;
+}
+
+static size_t name_slot(string** names, uint32_t size, string* name) {
+    size_t slot = ((uintptr_t)name >> 4) & (size - 1);
+    while (names[slot] != NULL && names[slot] != name) {
+        slot = (slot + 1) & (size - 1);
+    }
+    return slot;
+}
+
+// internovane nazvy se opakuji, v souboru je kazdy jen jednou
+static uint32_t writer_name(struct cache_writer* w, string* name) {
+    if (2 * (w->name_count + 1) > w->name_size) {
+        uint32_t size = (w->name_size) ? w->name_size * 2 : 1024;
+        string** names = calloc(size, sizeof(string*));
+        uint32_t* offsets = malloc(size * sizeof(uint32_t));
+        if (!names || !offsets) {
+            free(names);
+            free(offsets);
+            w->failed = true;
+            return 0;
+        }
+        for (uint32_t i = 0; i < w->name_size; i++) {
+            if (w->names[i]) {
+                size_t slot = name_slot(names, size, w->names[i]);
+                names[slot] = w->names[i];
+                offsets[slot] = w->name_offsets[i];
+            }
+        }
+        free(w->names);
+        free(w->name_offsets);
+        w->names = names;
+        w->name_offsets = offsets;
+        w->name_size = size;
+    }
+
+    size_t slot = name_slot(w->names, w->name_size, name);
+    if (w->names[slot] == NULL) {
+        w->names[slot] = name;
+        w->name_offsets[slot] = writer_text(w, name);
+        w->name_count++;
+    }
+    return w->name_offsets[slot];
+}
+
+static void writer_record(struct cache_writer* w, uint32_t i) {
+    struct ast_node* node = w->nodes[i];
+    struct cache_node* record = &w->records[i];
+
+    memset(record, 0, sizeof(struct cache_node));
+    record->type = node->type;
+    record->var_type = node->var_type;
+    record->literal = node->literal;
+    record->leaf = node->leaf;
+    record->left = (node->leaf) ? CACHE_NONE : writer_node(w, node->left);
+    record->right = (node->leaf) ? CACHE_NONE : writer_node(w, node->right);
+
+    switch (node_payload(node->type, node->literal)) {
+        case PAYLOAD_NAME:
+            record->payload[0] = (node->d.string_data) ? writer_name(w, node->d.string_data) : writer_text(w, NULL);
+            break;
+        case PAYLOAD_TEXT:
+            record->payload[0] = writer_text(w, node->d.string_data);
+            break;
+        case PAYLOAD_CONDITION:
+            record->payload[0] = (uint32_t)writer_node(w, node->d.condition);
+            break;
+        case PAYLOAD_LIST: {
+            struct ast_list* list = node->d.list;
+            uint32_t count = (list) ? (uint32_t)list->count : 0;
+            uint32_t first = w->elem_count;
+            if (!writer_grow((void**)&w->elems, &w->elem_size, first + count, sizeof(int32_t))) {
+                w->failed = true;
+                return;
+            }
+            for (uint32_t e = 0; e < count; e++) {
+                w->elems[first + e] = writer_node(w, list->elems[e]);
+            }
+            w->elem_count += count;
+            record->payload[0] = first;
+            record->payload[1] = count;
+            break;
+        }
+        case PAYLOAD_RAW:
+            memcpy(&record->payload, &node->d, sizeof(node->d));
+            break;
+    }
+}
+
+bool cache_store(const char* source_file, struct ast_node* tree) {
+    struct cache_writer w;
+    struct cache_header header;
+    uint32_t records_size = 0;
+    bool ok = false;
+
+    memset(&w, 0, sizeof(w));
+    writer_node(&w, tree);
+    // fronta do sirky, zaznam uzlu pridava do fronty jeho potomky
+    for (uint32_t i = 0; i < w.node_count && !w.failed; i++) {
+        if (!writer_grow((void**)&w.records, &records_size, i + 1, sizeof(struct cache_node))) {
+            w.failed = true;
+            break;
+        }
+        writer_record(&w, i);
+    }
+
+    // vraceni indexu pro ploche vyrazy
+    for (uint32_t i = 0; i < w.node_count; i++) {
+        w.nodes[i]->index = FLAT_NONE;
+    }
+
+    char* path = cache_path(source_file);
+    char* tmp = cache_path(source_file);
+    if (!w.failed && path && tmp) {
+        memcpy(header.magic, "IFJC", 4);
+        header.version = CACHE_VERSION;
+        header.source_hash = source_hash();
+        header.source_size = (uint64_t)(input_end - input_start);
+        header.node_count = w.node_count;
+        header.elem_count = w.elem_count;
+        header.text_size = w.text_size;
+        header.reserved = 0;
+
+        // zapis do docasneho souboru a prejmenovani, ctenar nikdy nevidi pulku
+        strcat(tmp, ".tmp");
+        FILE* f = fopen(tmp, "wb");
+        if (f) {
+            ok = fwrite(&header, sizeof(header), 1, f) == 1
+                && fwrite(w.records, sizeof(struct cache_node), w.node_count, f) == w.node_count
+                && fwrite(w.elems, sizeof(int32_t), w.elem_count, f) == w.elem_count
+                && fwrite(w.text, 1, w.text_size, f) == w.text_size;
+            ok = (fclose(f) == 0) && ok;
+            ok = ok && rename(tmp, path) == 0;
+            if (!ok) {
+                remove(tmp);
+            }
+        }
+    }
+
+    free(path);
+    free(tmp);
+    free(w.nodes);
+    free(w.records);
+    free(w.elems);
+    free(w.text);
+    free(w.names);
+    free(w.name_offsets);
+
+    return ok;
+}
+
+// --- nacitani ---
+
+// retezec z oblasti retezcu, NULL pri spatnem offsetu
+static string* load_text(const char* text, uint32_t text_size, uint32_t offset, bool name) {
+    uint32_t len;
+    if (text_size < sizeof(uint32_t) || offset > text_size - sizeof(uint32_t)) {
+        return NULL;
+    }
+    memcpy(&len, text + offset, sizeof(uint32_t));
+    if (len > text_size - offset - sizeof(uint32_t)) {
+        return NULL;
+    }
+    text += offset + sizeof(uint32_t);
+    // nazvy musi byt stejny ukazatel jako ze scanneru
+    return (name) ? intern(text, (int)len) : new_str_len(text, (int)len);
+}
+
+// potomek ma vetsi index nez rodic (uzly jsou ocislovane do sirky),
+// takze ani poskozena cache nevytvori cyklus
+static bool valid_child(int32_t child, uint32_t parent, uint32_t count) {
+    return child == CACHE_NONE || (child > (int32_t)parent && (uint32_t)child < count);
+}
+
+// typ potomka (index uz overeny), CACHE_NONE kdyz chybi
+static int child_type(const struct cache_node* records, int32_t child) {
+    return (child == CACHE_NONE) ? CACHE_NONE : records[child].type;
+}
+
+// potomci a data, ktere interpret u uzlu daneho typu bere jako dane;
+// listy (literal, promenna) jsou jen ve vyrazech, polozky seznamu se
+// kontroluji pri nacitani seznamu
+static bool valid_shape(const struct cache_node* records, uint32_t i) {
+    const struct cache_node* record = &records[i];
+    int left = child_type(records, record->left);
+    int right = child_type(records, record->right);
+
+    if (record->leaf && record->type != AST_LITERAL && record->type != AST_VAR) {
+        return false;
+    }
+
+    switch (record->type) {
+        case AST_FUNCTION:
+            return left == AST_FUNCTION_ARGUMENTS && (right == AST_BODY || right == AST_LAZY_BODY);
+        case AST_IF:
+            return (int32_t)record->payload[0] != CACHE_NONE && left == AST_BLOCK && right == AST_BLOCK;
+        case AST_FOR:
+            return left == AST_BLOCK && record->payload[1] == 3;
+        case AST_ASSIGN:
+            return (left == AST_VAR || left == AST_VAR_CREATION) && right != CACHE_NONE;
+        case AST_VAR_CREATION:
+            return left != CACHE_NONE && right == AST_VAR;
+        case AST_RETURN:
+            return left != CACHE_NONE;
+        case AST_BINARY_OP: // tabulka nechava chybejici operand interpretu (chyba 8)
+            return record->payload[0] <= AST_BINARY_EQUALS;
+        case AST_CALL:
+            return left == AST_FUNCTION_ARGUMENTS;
+        case AST_LITERAL:
+            return record->literal <= AST_LITERAL_STRING;
+        case AST_LAZY_BODY:
+            return record->payload[0] < (uint64_t)(input_end - input_start);
+        case AST_FUNCTION_LIST:
+        case AST_FUNCTION_ARGUMENTS:
+        case AST_BODY:
+        case AST_BLOCK:
+        case AST_COUT:
+        case AST_CIN:
+        case AST_EXPRESSION: // prazdny vyraz nema left
+        case AST_VAR:
+        case AST_NONE: // prazdny prikaz
+        case 0: // datovy typ deklarace, jen var_type
+            return true;
+        default:
+            return false;
+    }
+}
+
+// prvek seznamu: vzdy uzel, funkce v seznamu funkci a promenna v cin
+static bool valid_elem(const struct cache_node* records, uint32_t i, int32_t elem, uint32_t count) {
+    if (elem == CACHE_NONE || !valid_child(elem, i, count)) {
+        return false;
+    }
+    switch (records[i].type) {
+        case AST_FUNCTION_LIST:
+            return records[elem].type == AST_FUNCTION;
+        case AST_CIN:
+            return records[elem].type == AST_VAR;
+        default:
+            return true;
+    }
+}
+
+static struct ast_node* load_tree(const unsigned char* data, size_t size) {
+    struct cache_header header;
+
+    if (size < sizeof(header)) {
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "IFJC", 4) || header.version != CACHE_VERSION
+        || header.source_size != (uint64_t)(input_end - input_start)
+        || header.source_hash != source_hash() || header.node_count == 0) {
+        return NULL;
+    }
+    if (size != sizeof(header) + (uint64_t)header.node_count * sizeof(struct cache_node)
+        + (uint64_t)header.elem_count * sizeof(int32_t) + header.text_size) {
+        return NULL;
+    }
+
+    const struct cache_node* records = (const struct cache_node*)(data + sizeof(header));
+    const int32_t* elems = (const int32_t*)(records + header.node_count);
+    const char* text = (const char*)(elems + header.elem_count);
+    if (records[0].type != AST_FUNCTION_LIST) {
+        return NULL;
+    }
+    struct ast_node** nodes = malloc(header.node_count * sizeof(struct ast_node*));
+    bool ok = (nodes != NULL);
+
+    // nejdriv vsechny uzly, potom ukazatele mezi nimi
+    for (uint32_t i = 0; ok && i < header.node_count; i++) {
+        nodes[i] = (records[i].leaf) ? ast_create_leaf() : ast_create_node();
+        nodes[i]->type = records[i].type;
+        nodes[i]->var_type = records[i].var_type;
+        nodes[i]->literal = records[i].literal;
+    }
+
+    for (uint32_t i = 0; ok && i < header.node_count; i++) {
+        const struct cache_node* record = &records[i];
+        struct ast_node* node = nodes[i];
+
+        if (!valid_child(record->left, i, header.node_count) || !valid_child(record->right, i, header.node_count)
+            || (record->leaf && (record->left != CACHE_NONE || record->right != CACHE_NONE))
+            || (record->type == AST_IF && !valid_child((int32_t)record->payload[0], i, header.node_count))
+            || !valid_shape(records, i)) {
+            ok = false;
+            break;
+        }
+        if (!record->leaf) {
+            node->left = (record->left == CACHE_NONE) ? NULL : nodes[record->left];
+            node->right = (record->right == CACHE_NONE) ? NULL : nodes[record->right];
+        }
+
+        switch (node_payload(record->type, record->literal)) {
+            case PAYLOAD_NAME:
+            case PAYLOAD_TEXT: {
+                bool name = node_payload(record->type, record->literal) == PAYLOAD_NAME;
+                ok = (node->d.string_data = load_text(text, header.text_size, record->payload[0], name)) != NULL;
+                break;
+            }
+            case PAYLOAD_CONDITION: {
+                node->d.condition = nodes[record->payload[0]];
+                break;
+            }
+            case PAYLOAD_LIST: {
+                uint32_t first = record->payload[0];
+                uint32_t count = record->payload[1];
+                ok = first <= header.elem_count && count <= header.elem_count - first;
+                node->d.list = ast_create_list();
+                for (uint32_t e = 0; ok && e < count; e++) {
+                    int32_t elem = elems[first + e];
+                    ok = valid_elem(records, i, elem, header.node_count);
+                    if (ok) {
+                        ast_list_insert(node->d.list, nodes[elem]);
+                    }
+                }
+                break;
+            }
+            case PAYLOAD_RAW:
+                memcpy(&node->d, &record->payload, sizeof(node->d));
+                break;
+        }
+    }
+
+    struct ast_node* tree = (ok) ? nodes[0] : NULL;
+    free(nodes);
+    if (!tree) {
+        // poskozena cache, strom se postavi parserem od zacatku
+        ast_release();
+    }
+    return tree;
+}
+
+struct ast_node* cache_load(const char* source_file) {
+    struct ast_node* tree = NULL;
+    char* path = cache_path(source_file);
+    FILE* f = (path) ? fopen(path, "rb") : NULL;
+    free(path);
+    if (!f) {
+        return NULL;
+    }
+
+#ifndef _WIN32
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (map != MAP_FAILED) {
+            tree = load_tree(map, (size_t)st.st_size);
+            munmap(map, (size_t)st.st_size);
+            fclose(f);
+            return tree;
+        }
+    }
+#endif
+
+    // bez mmap jednim ctenim
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        unsigned char* data = (size > 0) ? malloc((size_t)size) : NULL;
+        if (data && fseek(f, 0, SEEK_SET) == 0 && fread(data, 1, (size_t)size, f) == (size_t)size) {
+            tree = load_tree(data, (size_t)size);
+        }
+        free(data);
+    }
+    fclose(f);
+
+    return tree;
+}
@@ -0,0 +1,14 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include "ast.h"
+
+// Prelozeny program na disku (--cache): strom po parsovani se ulozi vedle
+// zdrojaku jako <zdrojak>.ifjc. Plati jen pro stejny obsah zdrojaku (hash
+// FNV-1a 64 a delka) a stejnou CACHE_VERSION, jinak se parsuje znovu.
+// Zdrojak uz musi byt nacteny pres set_input.
+struct ast_node* cache_load(const char* source_file); // NULL = cache chybi nebo neplati
+bool cache_store(const char* source_file, struct ast_node* tree);
+
+#endif
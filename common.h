@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "string.h"
 
 #define DEBUG // enables DEBUGGING information
 //#define UNIT_TEST
@@ -55,6 +56,7 @@ enum lex_type
   COLON, //33
   END_OF_FILE //34
 };
+#define LEX_TYPE_COUNT (END_OF_FILE + 1)
 
 enum literal_type
 {
@@ -68,9 +70,12 @@ struct lexeme {
   enum lex_type type; //typ
   union {
     char *string;
+    string *symbol; //identifikator - jedinecny retezec z tabulky nazvu (intern.h)
     int integer;
     double real;
   } value; //hodnota ulozena ve value (pokud obsahuje)
+  int offset; //zacatek lexemu ve zdrojovem textu (u retezce az za uvozovkou)
+  int length; //delka identifikatoru/retezce (bez uvozovek)
 };
 
 struct data
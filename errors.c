@@ -14,8 +14,11 @@
 #include <err.h>
 #endif
 
+#include <string.h>
 #include "errors.h"
 
+static __thread struct error_trap *error_trap = NULL;
+
 const struct compiler_error compiler_errors[] = {
   { 0, "no error" },
   { 1, "lexical error" },
@@ -32,6 +35,23 @@ const struct compiler_error compiler_errors[] = {
 };
 
 void throw_error(ERROR_CODE type, const char *msg) {
+  if(error_trap) {
+    error_trap->type = type;
+    error_trap->has_msg = (msg != NULL);
+    if(msg) {
+      strncpy(error_trap->msg, msg, ERROR_MSG_SIZE - 1);
+      error_trap->msg[ERROR_MSG_SIZE - 1] = 0;
+    }
+    longjmp(error_trap->jump, 1);
+  }
   if(!msg) errx(compiler_errors[type].return_value, "%s", compiler_errors[type].err_msg);
   else errx(compiler_errors[type].return_value, "%s: %s", compiler_errors[type].err_msg, msg);
 }
+
+void set_error_trap(struct error_trap *trap) {
+  error_trap = trap;
+}
+
+void rethrow_error(struct error_trap *trap) {
+  throw_error(trap->type, (trap->has_msg) ? trap->msg : NULL);
+}
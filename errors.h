@@ -1,12 +1,26 @@
 #ifndef ERRORS_H
 #define ERRORS_H
 
+#include <setjmp.h>
 #include "common.h"
 struct compiler_error {
   int return_value;
   char* err_msg;
 };
 
+#define ERROR_MSG_SIZE 256
+
+// zachyceni chyby v pomocnem vlakne - throw_error misto ukonceni programu
+// ulozi chybu a skoci na jump, hlavni vlakno ji pak vyhodi pres rethrow_error
+struct error_trap {
+  jmp_buf jump;
+  ERROR_CODE type;
+  int has_msg;
+  char msg[ERROR_MSG_SIZE];
+};
+
 void throw_error(ERROR_CODE type, const char* err);
+void set_error_trap(struct error_trap *trap); // plati jen pro volajici vlakno, NULL vypina
+void rethrow_error(struct error_trap *trap);
 
 #endif
@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include "flat.h"
+#include "gc.h"
+#include "errors.h"
+#include "typecheck.h"
+
+#define FLAT_INITIAL 1024
+
+struct flat_ast flat = { NULL, NULL, NULL, NULL, NULL, 0, 0, NULL, 0, 0 };
+
+#define GROW(array, type) do { \
+        if (!(flat.array = gc_realloc(flat.array, (int)(capacity * sizeof(type))))) \
+            throw_error(CODE_ERROR_INTERNAL, "cannot allocate flat ast"); \
+    } while (0)
+
+static void flat_grow()
+{
+    int32_t capacity = (flat.capacity) ? flat.capacity * 2 : FLAT_INITIAL;
+    GROW(kind, uint8_t);
+    GROW(op, uint8_t);
+    GROW(left, int32_t);
+    GROW(right, int32_t);
+    GROW(value, union ast_node_data);
+    flat.capacity = capacity;
+}
+
+static int32_t flat_add_call(struct ast_node* call)
+{
+    if (flat.call_count == flat.call_capacity) {
+        int32_t capacity = (flat.call_capacity) ? flat.call_capacity * 2 : FLAT_INITIAL;
+        GROW(calls, struct ast_node*);
+        flat.call_capacity = capacity;
+    }
+
+    flat.calls[flat.call_count] = call;
+    return flat.call_count++;
+}
+
+static int32_t flat_add(enum flat_kind kind)
+{
+    if (flat.count == flat.capacity) {
+        flat_grow();
+    }
+
+    int32_t i = flat.count++;
+    flat.kind[i] = kind;
+    flat.op[i] = 0;
+    flat.left[i] = FLAT_NONE;
+    flat.right[i] = FLAT_NONE;
+    return i;
+}
+
+// obal vyrazu se rozbaluje stejne jako v EvaluateExpression
+static struct ast_node* flat_unwrap(struct ast_node* expr)
+{
+    return (expr != NULL && expr->type == AST_EXPRESSION) ? expr->left : expr;
+}
+
+static int32_t flat_convert_leaf(struct ast_node* expr)
+{
+    int32_t i;
+
+    if (expr == NULL) {
+        return flat_add(FLAT_OTHER);
+    }
+
+    switch (expr->type) {
+        case AST_LITERAL:
+            i = flat_add(FLAT_LITERAL);
+            flat.op[i] = (uint8_t)expr->literal;
+            flat.value[i] = expr->d;
+            break;
+        case AST_VAR:
+            i = flat_add(FLAT_VAR);
+            flat.left[i] = expr->index; // slot z resolveru
+            flat.value[i] = expr->d;
+            break;
+        case AST_CALL:
+            i = flat_add(FLAT_CALL);
+            flat.left[i] = flat_add_call(expr);
+            break;
+        default:
+            i = flat_add(FLAT_OTHER);
+            break;
+    }
+
+    return i;
+}
+
+// levotocive retezce (a + b + c + ...) jsou hluboke, proto se leva vetev
+// prochazi cyklem a rekurze jde jen do pravych podstromu
+int32_t flat_convert(struct ast_node* expr)
+{
+    // leve vetve od korene dolu, rekurzivni volani pro prave podstromy
+    // pouzivaji cast pole nad spine_used
+    static struct ast_node** spine = NULL;
+    static int spine_size = 0;
+    static int spine_used = 0;
+    int spine_base, spine_top;
+    int32_t i;
+
+    expr = flat_unwrap(expr);
+    if (expr == NULL || expr->type != AST_BINARY_OP) {
+        return flat_convert_leaf(expr);
+    }
+
+    spine_base = spine_top = spine_used;
+    while (expr != NULL && expr->type == AST_BINARY_OP) {
+        if (spine_top == spine_size) {
+            spine_size = (spine_size) ? spine_size * 2 : 64;
+            if (!(spine = gc_realloc(spine, (int)(spine_size * sizeof(struct ast_node*)))))
+                throw_error(CODE_ERROR_INTERNAL, "cannot allocate flat ast");
+        }
+        spine[spine_top++] = expr;
+        expr = flat_unwrap(expr->left);
+    }
+    spine_used = spine_top;
+
+    // potomci pred rodicem: nejlevejsi list, pak od spodu pravy podstrom a operator
+    i = flat_convert_leaf(expr);
+    while (spine_top > spine_base) {
+        struct ast_node* op = spine[--spine_top];
+        int32_t right = flat_convert(op->right);
+        int32_t node = flat_add(FLAT_BINARY);
+        flat.op[node] = (uint8_t)op->d.binary;
+        if (op->literal == TYPECHECK_DONE) {
+            flat.op[node] |= FLAT_TYPED;
+        }
+        flat.left[node] = i;
+        flat.right[node] = right;
+        i = node;
+    }
+    spine_used = spine_base;
+
+    return i;
+}
+
+int32_t flat_first(int32_t root)
+{
+    // nejlevejsi list je v postfixu prvni
+    while (flat.kind[root] == FLAT_BINARY) {
+        root = flat.left[root];
+    }
+    return root;
+}
+
+size_t flat_memory_used()
+{
+    return (size_t)flat.count * (2 * sizeof(uint8_t) + 2 * sizeof(int32_t) + sizeof(union ast_node_data))
+        + (size_t)flat.call_count * sizeof(struct ast_node*);
+}
+
+void flat_release()
+{
+    free(flat.kind);
+    free(flat.op);
+    free(flat.left);
+    free(flat.right);
+    free(flat.value);
+    free(flat.calls);
+    flat.kind = flat.op = NULL;
+    flat.left = flat.right = NULL;
+    flat.value = NULL;
+    flat.calls = NULL;
+    flat.count = flat.capacity = 0;
+    flat.call_count = flat.call_capacity = 0;
+}
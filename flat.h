@@ -0,0 +1,48 @@
+#ifndef FLAT_H
+#define FLAT_H
+
+#include <stdint.h>
+#include "ast.h"
+
+// Plocha reprezentace vyrazu (struct-of-arrays). Uzel je index do
+// paralelnich poli, potomci jsou 32bitove indexy misto ukazatelu.
+// Kazdy vyraz lezi souvisle v postfixovem poradi (levy podstrom, pravy
+// podstrom, uzel), takze se da vyhodnotit jednim pruchodem se zasobnikem
+// ve stejnem poradi jako rekurzivni pruchod stromem.
+
+#define FLAT_NONE (-1)
+#define FLAT_TYPED 0x80 // v op binarni operace: typy operandu overila typova kontrola (typecheck.h)
+
+enum flat_kind
+{
+    FLAT_OTHER, // uzel, ktery neni vyrazem - vyhodnoti se na NULL
+    FLAT_LITERAL,
+    FLAT_VAR,
+    FLAT_BINARY,
+    FLAT_CALL,
+};
+
+struct flat_ast
+{
+    uint8_t* kind; // enum flat_kind
+    uint8_t* op; // enum ast_binary_op_type nebo enum ast_literal_type
+    int32_t* left; // levy potomek binarni operace, u volani index do calls, u promenne slot,
+                   // u literalu hodnota v interpretu (FLAT_NONE = jeste nevyhodnocen)
+    int32_t* right;
+    union ast_node_data* value; // literal, nazev promenne
+    int32_t count;
+    int32_t capacity;
+
+    struct ast_node** calls; // puvodni uzly volani (argumenty zustavaji ve stromu)
+    int32_t call_count;
+    int32_t call_capacity;
+};
+
+extern struct flat_ast flat;
+
+int32_t flat_convert(struct ast_node* expr); // prevede vyraz, vraci index korene
+int32_t flat_first(int32_t root); // prvni uzel vyrazu s korenem root
+size_t flat_memory_used();
+void flat_release();
+
+#endif
@@ -0,0 +1,312 @@
+#include <stdlib.h>
+#include "fold.h"
+#include "typecheck.h"
+#include "interpret.h"
+#include "flat.h"
+#include "gc.h"
+#include "errors.h"
+
+#define FOLD_INITIAL 64
+
+// pro kazdy slot funkce: kolikrat se do nej zapisuje mimo deklaraci
+// s inicializaci a konstanta, kterou ma
+struct slot_info {
+	int writes;
+	bool constant;
+	enum ast_literal_type literal;
+	union ast_node_data value;
+};
+
+static struct slot_info* slots = NULL;
+static int slot_capacity = 0;
+
+// uzel vyrazu cekajici na zasobniku; expanded = operandy uz jsou nad nim
+struct fold_frame {
+	struct ast_node* node;
+	bool expanded;
+};
+
+static struct fold_frame* frames = NULL;
+static int frame_capacity = 0;
+static bool* results = NULL;
+static int result_capacity = 0;
+
+static void* fold_grow(void* array, int* capacity, int needed, size_t item) {
+	while (*capacity < needed) {
+		*capacity = (*capacity) ? *capacity * 2 : FOLD_INITIAL;
+	}
+	if (!(array = gc_realloc(array, (int)(*capacity * item)))) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate constant folding");
+	}
+	return array;
+}
+
+static struct ast_node* unwrap(struct ast_node* expr) {
+	return (expr != NULL && expr->type == AST_EXPRESSION) ? expr->left : expr;
+}
+
+static void written(struct ast_node* var) {
+	if (var->index >= 0) {
+		slots[var->index].writes++;
+	}
+}
+
+// prvni pruchod: zapisy do promennych
+static void count_list(struct ast_list* list);
+
+static void count_statement(struct ast_node* node) {
+	switch (node->type) {
+		case AST_ASSIGN:
+			if (node->left->type == AST_VAR) {
+				written(node->left);
+			}
+			break;
+		case AST_VAR_CREATION:
+			written(node->right); // bez inicializace, konstantou nebude
+			break;
+		case AST_CIN:
+			for (int i = 0; i < node->d.list->count; i++) {
+				written(node->d.list->elems[i]);
+			}
+			break;
+		case AST_IF:
+			count_list(node->left->d.list);
+			count_list(node->right->d.list);
+			break;
+		case AST_FOR:
+			count_statement(node->d.list->elems[0]);
+			count_statement(node->d.list->elems[2]);
+			count_list(node->left->d.list);
+			break;
+		case AST_BLOCK:
+			count_list(node->d.list);
+			break;
+		default:
+			break;
+	}
+}
+
+static void count_list(struct ast_list* list) {
+	for (int i = 0; i < list->count; i++) {
+		count_statement(list->elems[i]);
+	}
+}
+
+static enum ast_literal_type literal_type(Variable* value) {
+	switch (value->data_type) {
+		case AST_VAR_INT:
+			return AST_LITERAL_INT;
+		case AST_VAR_DOUBLE:
+			return AST_LITERAL_REAL;
+		case AST_VAR_STRING:
+			return AST_LITERAL_STRING;
+		case AST_VAR_BOOL:
+			return value->data.bool_data ? AST_LITERAL_TRUE : AST_LITERAL_FALSE;
+		default:
+			return AST_LITERAL_NULL;
+	}
+}
+
+// uzel (i list, literal se vejde do hlavicky) se prepise na literal
+static void make_literal(struct ast_node* node, enum ast_literal_type literal, union ast_node_data value) {
+	node->type = AST_LITERAL;
+	node->literal = (uint8_t)literal;
+	node->d = value;
+	node->index = FLAT_NONE;
+}
+
+static Variable literal_value(struct ast_node* literal) {
+	Variable value;
+	value.data_type = GetVarTypeFromLiteral(literal->literal);
+	value.data = literal->d;
+	value.initialized = true;
+	return value;
+}
+
+// jen operace overene typovou kontrolou, a to bez prevodu int <-> bool
+// (ty za behu ctou jinou polozku unie) a bez deleni nulou
+static bool fold_operation(struct ast_node* op) {
+	struct ast_node* left = unwrap(op->left);
+	struct ast_node* right = unwrap(op->right);
+
+	if (op->literal != TYPECHECK_DONE || left->type != AST_LITERAL || right->type != AST_LITERAL) {
+		return false;
+	}
+
+	Variable l = literal_value(left);
+	Variable r = literal_value(right);
+	if (l.data_type != r.data_type && !(l.data_type == AST_VAR_DOUBLE && r.data_type == AST_VAR_INT)) {
+		return false;
+	}
+	if (op->d.binary == AST_BINARY_DIVIDE && (l.data_type == AST_VAR_INT || l.data_type == AST_VAR_DOUBLE)
+		&& ((int)r.data.numeric_data == 0 || r.data.numeric_data == 0)) {
+		return false;
+	}
+
+	Variable* result = EvaluateOperation(op->d.binary, &l, &r);
+	make_literal(op, literal_type(result), result->data);
+	gc_free(result);
+	return true;
+}
+
+static bool fold_leaf(struct ast_node* expr) {
+	if (expr == NULL) {
+		return false;
+	}
+
+	switch (expr->type) {
+		case AST_LITERAL:
+			return true;
+		case AST_VAR:
+			if (expr->index >= 0 && slots[expr->index].constant) {
+				make_literal(expr, slots[expr->index].literal, slots[expr->index].value);
+				return true;
+			}
+			return false;
+		default:
+			return false;
+	}
+}
+
+static int push_frame(int top, struct ast_node* node) {
+	if (top == frame_capacity) {
+		frames = fold_grow(frames, &frame_capacity, top + 1, sizeof(struct fold_frame));
+	}
+	frames[top].node = unwrap(node);
+	frames[top].expanded = false;
+	return top + 1;
+}
+
+static int push_result(int top, bool constant) {
+	if (top == result_capacity) {
+		results = fold_grow(results, &result_capacity, top + 1, sizeof(bool));
+	}
+	results[top] = constant;
+	return top + 1;
+}
+
+// postorder s vlastnim zasobnikem (jako resolve_expression), hloubka
+// zavorek tak neomezuje zasobnik volani; vysledky operandu cekaji
+// v results; vraci true, kdyz je z vyrazu literal
+static bool fold_expression(struct ast_node* expr) {
+	int top = push_frame(0, expr);
+	int done = 0;
+
+	while (top > 0) {
+		struct fold_frame* frame = &frames[top - 1];
+		struct ast_node* node = frame->node;
+
+		if (node != NULL && node->type == AST_BINARY_OP) {
+			if (!frame->expanded) {
+				frame->expanded = true;
+				top = push_frame(top, node->right);
+				top = push_frame(top, node->left);
+				continue;
+			}
+			done -= 2;
+			done = push_result(done, results[done] && results[done + 1] && fold_operation(node));
+		} else if (node != NULL && node->type == AST_CALL) {
+			struct ast_list* args = node->left->d.list;
+			if (!frame->expanded) {
+				frame->expanded = true;
+				for (int i = args->count - 1; i >= 0; i--) {
+					top = push_frame(top, args->elems[i]);
+				}
+				continue;
+			}
+			done -= args->count;
+			done = push_result(done, false);
+		} else {
+			done = push_result(done, fold_leaf(node));
+		}
+		top--;
+	}
+
+	return results[0];
+}
+
+// deklarace s konstantni hodnotou, do ktere se uz nezapisuje; hodnota
+// musi mit typ promenne (double z int literalu je jen jiny druh literalu)
+static void declare_constant(struct ast_node* creation, struct ast_node* value) {
+	enum ast_var_type type = creation->left->var_type;
+	enum ast_var_type value_type = GetVarTypeFromLiteral(value->literal);
+
+	if (creation->right->index < 0 || slots[creation->right->index].writes != 0) {
+		return;
+	}
+	struct slot_info* slot = &slots[creation->right->index];
+	if (type == AST_VAR_DOUBLE && value_type == AST_VAR_INT) {
+		slot->literal = AST_LITERAL_REAL;
+	} else if (type == AST_VAR_AUTO || type == value_type) {
+		slot->literal = value->literal;
+	} else {
+		return;
+	}
+	slot->value = value->d;
+	slot->constant = true;
+}
+
+static void fold_list(struct ast_list* list);
+
+static void fold_statement(struct ast_node* node) {
+	switch (node->type) {
+		case AST_ASSIGN:
+			if (fold_expression(node->right) && node->left->type == AST_VAR_CREATION) {
+				declare_constant(node->left, unwrap(node->right));
+			}
+			break;
+		case AST_EXPRESSION:
+		case AST_CALL:
+			fold_expression(node);
+			break;
+		case AST_RETURN:
+			fold_expression(node->left);
+			break;
+		case AST_IF:
+			fold_expression(node->d.condition);
+			fold_list(node->left->d.list);
+			fold_list(node->right->d.list);
+			break;
+		case AST_FOR:
+			fold_statement(node->d.list->elems[0]);
+			fold_expression(node->d.list->elems[1]);
+			fold_statement(node->d.list->elems[2]);
+			fold_list(node->left->d.list);
+			break;
+		case AST_BLOCK:
+			fold_list(node->d.list);
+			break;
+		case AST_COUT:
+			for (int i = 0; i < node->d.list->count; i++) {
+				fold_expression(node->d.list->elems[i]);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void fold_list(struct ast_list* list) {
+	for (int i = 0; i < list->count; i++) {
+		fold_statement(list->elems[i]);
+	}
+}
+
+void fold_function(struct ast_node* func) {
+	struct ast_list* params = func->left->d.list;
+
+	if (slot_capacity < func->index) {
+		slots = fold_grow(slots, &slot_capacity, func->index, sizeof(struct slot_info));
+	}
+	for (int32_t i = 0; i < func->index; i++) {
+		slots[i].writes = 0;
+		slots[i].constant = false;
+	}
+	// parametry se nastavuji pri volani
+	for (int i = 0; i < params->count; i++) {
+		written(params->elems[i]);
+	}
+
+	count_list(func->right->d.list);
+	fold_list(func->right->d.list);
+}
@@ -0,0 +1,17 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "ast.h"
+
+// Skladani konstant v rozlisene a typove zkontrolovane funkci
+// (resolver.h, typecheck.h). Binarni operace nad dvema literaly se
+// spocita predem stejnymi funkcemi jako za behu (EvaluateOperation) a uzel
+// se prepise na literal, vcetne spojeni retezcu. Deleni nulou se nesklada,
+// chyba 9 zustava az za behu. Promenna deklarovana s konstantni hodnotou,
+// do ktere se uz nikde nepriradi ani nenacita, se v dalsich vyrazech
+// nahradi literalem.
+
+// volat jednou, po typecheck_function a pred prvnim vyhodnocenim
+void fold_function(struct ast_node* func);
+
+#endif
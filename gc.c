@@ -9,10 +9,22 @@
 // #include<malloc.h>
 #include <stdlib.h>
 
+static long allocations = 0; // pocet alokaci (pro --bench-lex), alokuje se i z vlaken
+
 void* gc_malloc(int size) {
+	__atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
 	return malloc((size_t)size);
 }
 
+void* gc_realloc(void* x, int size) {
+	__atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+	return realloc(x, (size_t)size);
+}
+
+long gc_allocations() {
+	return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
 void gc_free(void* x) {
 	// nebudeme zatim volat
 }
@@ -6,6 +6,8 @@
 #define IFJ_GC_H
 
 void* gc_malloc(int size);
+void* gc_realloc(void* x, int size);
+long gc_allocations(); // kolikrat se od startu alokovalo
 void gc_free(void* x);
 
 #endif //IFJ_GC_H
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "ial.h"
 #include "errors.h"
 #include "common.h"
@@ -33,43 +34,11 @@ struct hash_table * create_table()
 }
 
 // vrati hash
+// klice jsou nazvy z tabulky nazvu (intern.h), hashuje se tedy adresa
 int make_hash(struct hash_table * hashtable, string* key)
 {
-
-	/* convert our string to an integer index */
-    unsigned long int hashval = 33;
-    unsigned int i = 0;
-    while (hashval < ULONG_MAX && i < strlen(key->str)) {
-            hashval = hashval << 8;
-            hashval += key->str[i];
-            i++;
-    }
-    return hashval % hashtable->size;
-
-	// #ifdef HASHTABLE_USE_SIMPLE_HASH
-	// for (hash = i = 0; i < key->len; hash = hash << 8, hash += key[i++]);
-	// #else /* Use: Jenkins' "One At a Time Hash" === Perl "Like" Hashing */
-	//  // http://en.wikipedia.org/wiki/Jenkins_hash_function
-	//  for ( hash = i = 0; i < keyLength; ++i ) {
-	// 	 hash += key[i], hash += ( hash << 10 ), hash ^= ( hash >> 6 );
-	//  }
-	//  hash += ( hash << 3 ), hash ^= ( hash >> 11 ), hash += ( hash << 15 );
-	// #endif
-
- // 	return hash % hashtable->size;
-
-	// unsigned long int hashval;
-	// int i = 0;
-    // char* key_as_string = key->str;
-	//
-    // // string na integer
-	// while(hashval < ULONG_MAX && i < key->len) {
-	// 	hashval = hashval << 8;
-	// 	hashval += key_as_string[i];
-	// 	i++;
-	// }
-	//
-	// return hashval % hashtable->size;
+    // adresy alokaci jsou zarovnane, spodni bity nic nerikaji
+    return (int)(((uintptr_t)key >> 4) % (uintptr_t)hashtable->size);
 }
 
 // vytvori novej hash_item na vlozeni
@@ -81,7 +50,8 @@ struct hash_item * make_item(string * key, void * value)
         throw_error(CODE_ERROR_INTERNAL, "malloc failure");
 	}
 
-	new->key = new_str(key->str);
+	// klic je jedinecny nazev, neni potreba ho kopirovat
+	new->key = key;
     new->value = value;
 	new->next = NULL;
 
@@ -92,61 +62,43 @@ struct hash_item * make_item(string * key, void * value)
 void add_item(struct hash_table * hashtable, string * key, void * value)
 {
     int index = make_hash(hashtable, key);
-    struct hash_item * next = hashtable->table[index];
-    struct hash_item * last = NULL;
-    // najdem posledni
-	while(next && next->key && strcmp(key->str, next->key->str) > 0 ) {
-		last = next;
-		next = next->next;
-	}
-	// klic sedi, prepisem hodnotu
-	if(next && next->key && strcmp(key->str, next->key->str) == 0 ) {
-        // na free kaslem, ale kdyby nahodou :D
-		// free(next->value);
-		next->value = value;
-    // nenasli jsme, zalozime novy
-	} else {
-		struct hash_item * new = make_item(key,value);
-        // jsme na zacatku
-		if(next == hashtable->table[index]) {
-			new->next = next;
-			hashtable->table[index] = new;
-		// jsme na konci seznamu
-		} else if (next == NULL) {
-			last->next = new;
-		// jsme nekde uprostred
-		} else  {
-			new->next = next;
-			last->next = new;
+    struct hash_item * ptr = hashtable->table[index];
+    // klic uz tam je, prepisem hodnotu
+	while(ptr) {
+		if (ptr->key == key) {
+			ptr->value = value;
+			return;
 		}
+		ptr = ptr->next;
 	}
+	// nenasli jsme, zalozime novy na zacatek seznamu
+	struct hash_item * new = make_item(key,value);
+	new->next = hashtable->table[index];
+	hashtable->table[index] = new;
 }
 
 // vrati hodnotu
 void * get_item(struct hash_table * hashtable, string * key)
 {
 	int index = make_hash(hashtable, key);
-    struct hash_item * ptr = NULL;
-    // hledame v seznamu
-	ptr = hashtable->table[index];
-	while(ptr && ptr->key && strcmp(key->str, ptr->key->str) > 0) {
+    struct hash_item * ptr = hashtable->table[index];
+    // hledame v seznamu, nazvy se porovnavaji ukazatelem
+	while(ptr) {
+		if (ptr->key == key) {
+			return ptr->value;
+		}
 		ptr = ptr->next;
 	}
-    // nasli radcove?
-	if(ptr == NULL || ptr->key == NULL || strcmp(key->str, ptr->key->str) != 0 ) {
-		return NULL;
-	} else {
-		return ptr->value;
-	}
 
+	return NULL;
 }
 
 /**sort**/
 char* sort(char* input)
 {
 	int c = strlen(input);
-	char* pom = (char *)malloc(c);
-	memcpy((void *)pom, (void *)input, c);
+	char* pom = (char *)malloc(c + 1);
+	memcpy((void *)pom, (void *)input, c + 1); // i s koncovou nulou
 
 	int j, tmp;
 	for(int inc = c/2; inc > 0; inc = inc/2) {
@@ -9,6 +9,7 @@
 #include "ast.h"
 
 // nova hashova tabulka co pisu ve ctvrtek pred odevzdanim
+// klice musi byt nazvy z tabulky nazvu (intern.h), porovnavaji se ukazatelem
 struct hash_item {
 	string* key;
 	void* value;
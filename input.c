@@ -1,21 +1,268 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // madvise
 #include <stdio.h>
 #include <stdlib.h>
 #include "input.h"
 #include "errors.h"
 
-static FILE *input_file = NULL;
+#ifndef _WIN32 // windows nema mmap, nacte se to celym blokem
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define READ_CHUNK 65536
+
+__thread const unsigned char *input_start = NULL;
+__thread const unsigned char *input_pos = NULL;
+__thread const unsigned char *input_end = NULL;
+
+static const unsigned char *mapped_start = NULL; // vstup z mmap, jinak NULL
+static const unsigned char *mapped_released = NULL; // az sem uz je vraceno systemu
+static int shared = 0; // text ctou parsery ve vic vlaknech, nic se nevraci
+
+// nacte cely proud jednim blokem (roury, stdin, soubory co nejdou namapovat)
+static void read_whole(FILE *f) {
+	unsigned char *buffer = NULL;
+	size_t length = 0, size = 0, n;
+
+	do {
+		if (length == size) {
+			size += (size) ? size : READ_CHUNK;
+			if (!(buffer = realloc(buffer, size)))
+				throw_error(CODE_ERROR_INTERNAL, "cannot allocate input buffer");
+		}
+		n = fread(buffer + length, 1, size - length, f);
+		length += n;
+	} while (n > 0);
+
+	if (ferror(f))
+		throw_error(CODE_ERROR_INTERNAL, "cannot read from input");
+
+	input_start = input_pos = buffer;
+	input_end = buffer + length;
+}
 
 void set_input(char *input) {
+	FILE *input_file;
 	if(!(input_file = (!input) ? stdin : fopen(input, "r")))
 		throw_error(CODE_ERROR_INTERNAL, "cannot open input file");
+
+#ifndef _WIN32
+	struct stat st;
+	if (fstat(fileno(input_file), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(input_file), 0);
+		if (map != MAP_FAILED) {
+			// lexer cte soubor jednou od zacatku do konce
+			posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+			input_start = input_pos = map;
+			input_end = input_pos + st.st_size;
+			mapped_start = mapped_released = map;
+			fclose(input_file);
+			return;
+		}
+	}
+#endif
+
+	read_whole(input_file);
+	if (input_file != stdin)
+		fclose(input_file);
+}
+
+void rewind_input(void) {
+	input_pos = input_start;
 }
 
-int get_char() {
-	if(!input_file) throw_error(CODE_ERROR_INTERNAL, "cannot read from input");
-	return getc(input_file);
+void input_set_shared(int enable) {
+	shared = enable;
 }
 
-int return_char(int c) {
-	if(!input_file) throw_error(CODE_ERROR_INTERNAL, "cannot read from input");
-	return ungetc(c, input_file);
+void input_release_before(const unsigned char *pos) {
+#ifndef _WIN32
+	static long page = 0;
+	if (!mapped_start || shared)
+		return;
+	if (!page)
+		page = sysconf(_SC_PAGESIZE);
+
+	// jen cele stranky; anonymni buffer z read_whole se nesmi zahodit
+	const unsigned char *end = mapped_start + ((pos - mapped_start) / page) * page;
+	if (end > mapped_released) {
+		madvise((void *)mapped_released, (size_t)(end - mapped_released), MADV_DONTNEED);
+		mapped_released = end;
+	}
+#else
+	(void)pos;
+#endif
+}
+
+// --- preskakovani bilych znaku a komentaru ---
+// vektorove verze projdou 32 (AVX2) nebo 16 (SSE2) bajtu najednou,
+// zbytek bufferu dojede skalarni smycka
+
+// bily znak je vsechno <= ' ' (stejne jako trida CC_SPACE/CC_WHITE/CC_NEWLINE)
+#define IS_WHITE(c) ((c) <= ' ')
+
+void skip_whitespace(void) {
+	const unsigned char *p = input_pos;
+
+#if defined(__AVX2__)
+	const __m256i limit = _mm256_set1_epi8(' ' + 1);
+	while (p + 32 <= input_end) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)p);
+		// max(v, 33) == v  <=>  v > ' '
+		unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), v));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 32;
+	}
+#elif defined(__SSE2__)
+	const __m128i limit = _mm_set1_epi8(' ' + 1);
+	while (p + 16 <= input_end) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, limit), v));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 16;
+	}
+#endif
+
+	while (p < input_end && IS_WHITE(*p))
+		p++;
+	input_pos = p;
+}
+
+void skip_line(void) {
+	const unsigned char *p = input_pos;
+
+#if defined(__AVX2__)
+	const __m256i nl = _mm256_set1_epi8('\n');
+	while (p + 32 <= input_end) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)p);
+		unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 32;
+	}
+#elif defined(__SSE2__)
+	const __m128i nl = _mm_set1_epi8('\n');
+	while (p + 16 <= input_end) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 16;
+	}
+#endif
+
+	while (p < input_end && *p != '\n')
+		p++;
+	input_pos = p;
+}
+
+void skip_block_comment(void) {
+	const unsigned char *p = input_pos;
+
+	// hleda se dvojice "*/" - porovnava se blok a blok posunuty o jeden bajt
+#if defined(__AVX2__)
+	const __m256i star = _mm256_set1_epi8('*');
+	const __m256i slash = _mm256_set1_epi8('/');
+	while (p + 33 <= input_end) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)p);
+		__m256i b = _mm256_loadu_si256((const __m256i *)(p + 1));
+		unsigned mask = (unsigned)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(a, star), _mm256_cmpeq_epi8(b, slash)));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 32;
+	}
+#elif defined(__SSE2__)
+	const __m128i star = _mm_set1_epi8('*');
+	const __m128i slash = _mm_set1_epi8('/');
+	while (p + 17 <= input_end) {
+		__m128i a = _mm_loadu_si128((const __m128i *)p);
+		__m128i b = _mm_loadu_si128((const __m128i *)(p + 1));
+		unsigned mask = (unsigned)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(a, star), _mm_cmpeq_epi8(b, slash)));
+		if (mask) {
+			input_pos = p + __builtin_ctz(mask);
+			return;
+		}
+		p += 16;
+	}
+#endif
+
+	while (p + 1 < input_end && !(p[0] == '*' && p[1] == '/'))
+		p++;
+	// neukonceny komentar - scanner narazi na konec vstupu a ohlasi chybu
+	input_pos = (p + 1 < input_end) ? p : input_end;
+}
+
+// --- hledani zavorek ---
+
+int next_brace(void) {
+	int c;
+
+	while ((c = get_char()) != EOF) {
+		switch (c) {
+			case '{':
+			case '}':
+				return c;
+			case '"':
+				while ((c = get_char()) != '"' && c != EOF) {
+					if (c == '\\')
+						get_char();
+				}
+				break;
+			case '/':
+				c = get_char();
+				if (c == '/') {
+					skip_line();
+				} else if (c == '*') {
+					skip_block_comment();
+					input_pos = (input_end - input_pos >= 2) ? input_pos + 2 : input_end;
+				} else {
+					return_char(c);
+				}
+				break;
+		}
+	}
+
+	return EOF;
+}
+
+int skip_braces(void) {
+	int depth = 1;
+
+	while (depth > 0) {
+		switch (next_brace()) {
+			case '{':
+				depth++;
+				break;
+			case '}':
+				depth--;
+				break;
+			default:
+				return 0;
+		}
+	}
+
+	return 1;
 }
@@ -1,3 +1,42 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdio.h>
+
+// zdrojovy text je cely v pameti (mmap, nebo jednorazove nacteni),
+// scanner jen posouva ukazatel. Ukazatele jsou pro kazde vlakno zvlast
+// (lexer v --pipeline, parsery v --parallel), text je spolecny.
+extern __thread const unsigned char *input_start; // zacatek zdrojoveho textu
+extern __thread const unsigned char *input_pos; // dalsi znak na vstupu
+extern __thread const unsigned char *input_end; // konec zdrojoveho textu
+
 void set_input(char *input);
-int get_char();
-int return_char(int c);
+void rewind_input(void); // zpet na zacatek zdrojoveho textu
+
+// rychle preskoceni casti vstupu, ktere scanner zahazuje (SSE2/AVX2, jinak skalarne)
+void skip_whitespace(void); // na prvni znak > ' '
+void skip_line(void); // na konec radku '\n' (ten se neprecte)
+void skip_block_comment(void); // na '*' z ukoncujiciho "*/", pripadne na konec vstupu
+
+// zavorky bez lexeru (--lazy, --parallel): retezce a komentare se preskoci
+int next_brace(void); // za dalsi '{' nebo '}' a vrati ji, EOF na konci vstupu
+int skip_braces(void); // input_pos je za '{', posune se za odpovidajici '}'; 0 = neuzavreno
+
+// namapovany vstup pred pos uz neni potreba drzet v pameti (--stream);
+// pri dalsim cteni se stranky nactou ze souboru znovu
+void input_release_before(const unsigned char *pos);
+// --parallel: kazde vlakno je jinde v textu, vraceni stranek se vypne
+void input_set_shared(int enable);
+
+// nacteni znaku ze vstupu, na konci bufferu vraci EOF
+static inline int get_char() {
+	return (input_pos < input_end) ? *input_pos++ : EOF;
+}
+
+// vraceni znaku na vstup - stejne jako ungetc se EOF nevraci
+static inline int return_char(int c) {
+	if (c != EOF) input_pos--;
+	return c;
+}
+
+#endif
@@ -0,0 +1,108 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include "intern.h"
+#include "string.h"
+#include "errors.h"
+#include "gc.h"
+
+#define INTERN_INITIAL_SIZE 1024 // musi byt mocnina dvojky
+
+struct intern_entry {
+	unsigned int hash;
+	string* name;
+};
+
+static struct intern_entry* table = NULL;
+static unsigned int table_size = 0;
+static unsigned int table_count = 0;
+
+// pri --parallel interuje vic vlaken najednou, jinak se nezamyka
+static int shared = 0;
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void intern_set_shared(int enable) {
+	shared = enable;
+}
+
+// FNV-1a
+static unsigned int intern_hash(const char* txt, int len) {
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < len; i++) {
+		hash ^= (unsigned char)txt[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// zvetsi tabulku na dvojnasobek a prehashuje (hash je ulozeny, retezce se neprochazi)
+static int intern_grow() {
+	unsigned int new_size = (table_size) ? table_size * 2 : INTERN_INITIAL_SIZE;
+	struct intern_entry* new_table = gc_malloc(new_size * sizeof(struct intern_entry));
+	if (!new_table) {
+		return 0;
+	}
+	memset(new_table, 0, new_size * sizeof(struct intern_entry));
+
+	for (unsigned int i = 0; i < table_size; i++) {
+		if (table[i].name) {
+			unsigned int j = table[i].hash & (new_size - 1);
+			while (new_table[j].name) {
+				j = (j + 1) & (new_size - 1);
+			}
+			new_table[j] = table[i];
+		}
+	}
+
+	free(table);
+	table = new_table;
+	table_size = new_size;
+	return 1;
+}
+
+// NULL jen pri nedostatku pameti
+static string* intern_lookup(const char* txt, int len) {
+	// plneni nejvyse do poloviny, at jsou retezce sond kratke
+	if (2 * (table_count + 1) > table_size && !intern_grow()) {
+		return NULL;
+	}
+
+	unsigned int hash = intern_hash(txt, len);
+	unsigned int i = hash & (table_size - 1);
+	while (table[i].name) {
+		if (table[i].hash == hash && table[i].name->len == len && !memcmp(table[i].name->str, txt, len)) {
+			return table[i].name;
+		}
+		i = (i + 1) & (table_size - 1);
+	}
+
+	table[i].hash = hash;
+	table[i].name = new_str_len(txt, len);
+	if (table[i].name) {
+		table_count++;
+	}
+
+	return table[i].name;
+}
+
+string* intern(const char* txt, int len) {
+	string* name;
+
+	if (shared) {
+		pthread_mutex_lock(&table_lock);
+		name = intern_lookup(txt, len);
+		pthread_mutex_unlock(&table_lock);
+	} else {
+		name = intern_lookup(txt, len);
+	}
+
+	if (!name) {
+		throw_error(CODE_ERROR_INTERNAL, "malloc failure");
+	}
+	return name;
+}
+
+string* intern_str(const char* txt) {
+	return intern(txt, strlen(txt));
+}
@@ -0,0 +1,13 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "string.h"
+
+// Tabulka jedinecnych nazvu (identifikatoru). Pro stejny nazev vraci vzdy
+// stejny ukazatel, takze nazvy staci porovnavat ukazatelem a hashovat
+// podle adresy. Vracene retezce se nesmi menit.
+string* intern(const char* txt, int len);
+string* intern_str(const char* txt);
+void intern_set_shared(int enable); // zamykani tabulky, kdyz interuje vic vlaken
+
+#endif
@@ -1,81 +1,175 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "interpret.h"
 #include "errors.h"
-#include "symbol_table.h"
 #include "gc.h"
 #include "ial.h"
 #include "string.h"
+#include "intern.h"
+#include "parser.h"
+#include "resolver.h"
+#include "typecheck.h"
+#include "fold.h"
 
 #define ASTNode struct ast_node // definition of ast node for definition file
 #define ASTList struct ast_list
 
-struct symbol_table* scopes;
-Stack functions;
+// promenne aktualniho volani po slotech z resolveru (viz resolver.h)
+struct frame {
+	Variable** vars; // slot -> promenna, NULL dokud deklarace neprobehla
+	Variable* cells; // misto pro promenne, cely ramec je jedna alokace
+};
+static struct frame frame;
 
-const int kBuiltinsCount = 5;
-string* kBuiltins[5];
+static struct frame NewFrame(ASTNode* func) {
+	struct frame f;
+	int slots = func->index;
 
-// PrepareFunctions will populate the stack of
-// functions, checking for redefinitions.
+	f.vars = gc_malloc(slots * (sizeof(Variable*) + sizeof(Variable)) + 1);
+	if (f.vars == NULL) {
+		throw_error(CODE_ERROR_INTERNAL, "[Interpret] Cannot allocate call frame");
+	}
+	f.cells = (Variable*)(f.vars + slots);
+	memset(f.vars, 0, slots * sizeof(Variable*));
+
+	return f;
+}
+
+// promenna podle slotu, NULL pokud neni deklarovana
+static Variable* FrameVariable(int32_t slot) {
+	return (slot >= 0) ? frame.vars[slot] : NULL;
+}
+
+// the value stored as the given (compatible) type, so a variable, parameter
+// or return value always holds a value of its declared type
+static union ast_node_data ConvertValue(Variable* value, enum ast_var_type type) {
+	union ast_node_data data = value->data;
+
+	if (type == AST_VAR_INT && value->data_type == AST_VAR_BOOL) {
+		data.numeric_data = value->data.bool_data;
+	} else if (type == AST_VAR_BOOL && value->data_type == AST_VAR_INT) {
+		data.bool_data = value->data.numeric_data != 0;
+	}
+	return data;
+}
+
+// builtins are in the function table as AST_FUNCTION nodes without body,
+// calls bind to them like to any other function and the node index
+// is the builtin id, so a call is dispatched without comparing names
+enum BuiltinId {
+	BUILTIN_CONCAT, BUILTIN_LENGTH, BUILTIN_SUBSTR, BUILTIN_FIND, BUILTIN_SORT, BUILTIN_COUNT
+};
+
+#define BUILTIN_MAX_PARAMS 3
+
+struct Builtin {
+	const char* name;
+	enum ast_var_type return_type;
+	int param_count;
+	enum ast_var_type params[BUILTIN_MAX_PARAMS];
+	Variable* (*call)(Variable** args);
+};
+
+static const struct Builtin kBuiltinTable[BUILTIN_COUNT] = {
+	[BUILTIN_CONCAT] = { "concat", AST_VAR_STRING, 2, { AST_VAR_STRING, AST_VAR_STRING }, BuiltInConcat },
+	[BUILTIN_LENGTH] = { "length", AST_VAR_INT, 1, { AST_VAR_STRING }, BuiltInLength },
+	[BUILTIN_SUBSTR] = { "substr", AST_VAR_STRING, 3, { AST_VAR_STRING, AST_VAR_INT, AST_VAR_INT }, BuiltInSubstr },
+	[BUILTIN_FIND] = { "find", AST_VAR_INT, 2, { AST_VAR_STRING, AST_VAR_STRING }, BuiltInFind },
+	[BUILTIN_SORT] = { "sort", AST_VAR_STRING, 1, { AST_VAR_STRING }, BuiltInSort },
+};
+
+ASTNode kBuiltins[BUILTIN_COUNT];
+
+// names are resolved, types checked and constants folded once,
+// before the body first runs
+static void PrepareBody(ASTNode* func) {
+	if (func->index == FLAT_NONE) {
+		resolve_function(func);
+		typecheck_function(func);
+		fold_function(func);
+	}
+}
+
+// PrepareFunctions will fill the function table, checking for
+// redefinitions, and then resolve and type check the bodies that are
+// parsed already, binding every call to its function
 void PrepareFunctions(ASTList* fcns) {
-	if (fcns == NULL || fcns->elem == NULL) {
+	if (fcns == NULL || fcns->count == 0) {
 		throw_error(CODE_ERROR_SEMANTIC, "No function was defined");
 	}
 
-	do {
-		ASTNode* func = fcns->elem;
-		// check for function redefinitions
-		if (FindFunction(func->d.string_data) != NULL || IsBuiltin(func->d.string_data)) {
+	for (int i = 0; i < fcns->count; i++) {
+		// names are interned, the table compares pointers
+		if (!resolve_add_function(fcns->elems[i])) {
 			throw_error(CODE_ERROR_SEMANTIC, "[Interpret][Redefinition] Function redefinition");
 		}
+	}
+
+	// bodies skipped by --lazy are prepared on the first call
+	for (int i = 0; i < fcns->count; i++) {
+		if (fcns->elems[i]->right->type != AST_LAZY_BODY) {
+			PrepareBody(fcns->elems[i]);
+		}
+	}
+}
 
-		StackPush(&functions, func);
-		fcns = fcns->next;
-	} while(fcns != NULL);
+static bool IsBuiltinFunction(ASTNode* func) {
+	return func->right == NULL;
 }
 
 ASTNode *FindFunction(string *name) {
-	Element* el = StackTopElement(&functions);
-	if (el == NULL) {
-		return NULL;
+	ASTNode* func = resolve_find_function(name);
+	return (func != NULL && !IsBuiltinFunction(func)) ? func : NULL;
+}
+
+// FunctionBody returns statements of the function, a body
+// skipped by --lazy is parsed on the first call
+ASTList* FunctionBody(ASTNode* func) {
+	if (func->right->type == AST_LAZY_BODY && !parser_parse_body(func->right)) {
+		throw_error(CODE_ERROR_SYNTAX, "[Interpret] Function body could not be parsed");
 	}
+	PrepareBody(func);
+	return func->right->d.list;
+}
 
-	do {
-		ASTNode* func = el->value;
-		if (equals(func->d.string_data, name)) {
-			return func;
+void InterpretInit(ASTList* fcns) {
+	for (int i = 0; i < BUILTIN_COUNT; i++) {
+		const struct Builtin* builtin = &kBuiltinTable[i];
+		// parameters are there for the resolver to check the argument count
+		ASTNode* params = ast_create_node();
+		params->type = AST_FUNCTION_ARGUMENTS;
+		params->d.list = ast_create_list();
+		for (int j = 0; j < builtin->param_count; j++) {
+			ASTNode* param = ast_create_node();
+			param->type = AST_VAR;
+			param->var_type = builtin->params[j];
+			ast_list_insert(params->d.list, param);
 		}
 
-		el = el->next;
-	} while(el != NULL);
-
-	return NULL;
-}
+		kBuiltins[i].type = AST_FUNCTION;
+		kBuiltins[i].var_type = builtin->return_type;
+		kBuiltins[i].index = i;
+		kBuiltins[i].d.string_data = intern_str(builtin->name);
+		kBuiltins[i].left = params;
+		kBuiltins[i].right = NULL;
+		resolve_add_function(&kBuiltins[i]);
+	}
 
-void InterpretInit(ASTList* fcns) {
-	kBuiltins[0] = new_str("concat");
-	kBuiltins[1] = new_str("length");
-	kBuiltins[2] = new_str("substr");
-	kBuiltins[3] = new_str("find");
-	kBuiltins[4] = new_str("sort");
-
-	scopes = init_table();
-	StackInit(&functions);
 	PrepareFunctions(fcns);
 }
 
 void InterpretRun() {
-	ASTNode* func = FindFunction(new_str("main"));
+	ASTNode* func = FindFunction(intern_str("main"));
 	if (func == NULL) {
 		throw_error(CODE_ERROR_SEMANTIC, "Main function could not be found");
 	}
 
-	scope_start(scopes, SCOPE_BLOCK);
+	ASTList* body = FunctionBody(func);
+	frame = NewFrame(func);
 	Variable *return_val = gc_malloc(sizeof(Variable));
-	InterpretList(func->right->d.list, return_val);
-
-	scope_end(scopes);
+	InterpretList(body, return_val);
 }
 
 void InterpretNode(ASTNode* node, Variable* return_val) {
@@ -108,9 +202,7 @@ void InterpretNode(ASTNode* node, Variable* return_val) {
 			InterpretFor(node, return_val);
 			break;
 		case AST_BLOCK:
-			scope_start(scopes, SCOPE_BLOCK);
 			InterpretList(node->d.list, return_val);
-			scope_end(scopes);
 		case AST_NONE:
 			// Empty Statement can happen from trailing semicolons after the expressions.
 			// Warn: This is hotfix
@@ -121,40 +213,36 @@ void InterpretNode(ASTNode* node, Variable* return_val) {
 }
 
 void InterpretVarCreation(ASTNode *var) {
-	if (!is_creatable(scopes, var->right->d.string_data)) {
+	int32_t slot = var->right->index;
+	if (slot == RESOLVE_REDEFINED) {
 		throw_error(CODE_ERROR_SEMANTIC, "Variable redefinition");
 	}
 
-	Variable *variable = gc_malloc(sizeof(Variable));
+	// v cyklu se bunka pouzije znovu, deklarace ji vynuluje
+	Variable *variable = &frame.cells[slot];
 	variable->data_type = var->left->var_type;
 	variable->data.numeric_data = 0; // null the data
 	variable->initialized = false;
 
-	set_symbol(scopes, var->right->d.string_data, variable);
+	frame.vars[slot] = variable;
 }
 
 void InterpretList(ASTList* list, Variable* return_val) {
 	return_val->data_type = AST_VAR_NULL;
 
-	// no interpretation for empty list needed
-	if (list->elem == NULL) {
-		return;
-	}
-
-	do {
-		if (list->elem->type != AST_RETURN) {
+	for (int i = 0; i < list->count && return_val->data_type == AST_VAR_NULL; i++) {
+		ASTNode* statement = list->elems[i];
+		if (statement->type != AST_RETURN) {
 			// interpret node on current leaf
-			InterpretNode(list->elem, return_val);
+			InterpretNode(statement, return_val);
 		} else {
 			// handle return
-			Variable *ret = EvaluateExpression(list->elem->left);
+			Variable *ret = EvaluateExpression(statement->left);
 			return_val->data_type = ret->data_type;
 			return_val->data = ret->data;
 			return_val->initialized = ret->initialized;
 		}
-		// change leaf to next
-		list = list->next;
-	} while (list != NULL && return_val->data_type == AST_VAR_NULL);
+	}
 }
 
 void InterpretAssign(ASTNode *statement) {
@@ -166,19 +254,19 @@ void InterpretAssign(ASTNode *statement) {
 	}
 
 	Variable* current = NULL;
-	string* var_name = NULL;
+	ASTNode* target = NULL;
 	switch (statement->left->type) {
 		case AST_VAR_CREATION:
 			InterpretVarCreation(statement->left);
-			var_name = statement->left->right->d.string_data;
+			target = statement->left->right;
 			break;
 		case AST_VAR:
-			var_name = statement->left->d.string_data;
+			target = statement->left;
 			break;
 		default:
 			throw_error(CODE_ERROR_RUNTIME_OTHER, "[Interpret] Provided ASTNode type not recognized");
 	}
-	current = get_symbol(scopes, var_name);
+	current = FrameVariable(target->index);
 
 	if (current == NULL) {
 		throw_error(CODE_ERROR_SEMANTIC, "[Interpret] Variable assigning failed due to missing variable");
@@ -195,11 +283,10 @@ void InterpretAssign(ASTNode *statement) {
 	// variable was assigned a value
 	current->initialized = true;
 
-	current->data = result->data;
+	current->data = ConvertValue(result, current->data_type);
 }
 
 void InterpretIf(ASTNode *ifstatement, Variable* return_val) {
-	scope_start(scopes, SCOPE_BLOCK);
 	Variable* condition_result = EvaluateExpression(ifstatement->d.condition);
 	if (!AreCompatibleTypes(condition_result->data_type, AST_VAR_BOOL)) {
 		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][If] Expression not bool");
@@ -208,97 +295,94 @@ void InterpretIf(ASTNode *ifstatement, Variable* return_val) {
 	ASTNode *block = condition_result->data.bool_data? ifstatement->left: ifstatement->right;
 
 	InterpretList(block->d.list, return_val);
-
-	scope_end(scopes);
 }
 
 bool IsBuiltin(string *name) {
-	for (int i = 0; i < kBuiltinsCount; i++) {
-		if (equals(name, kBuiltins[i])) {
-			return true;
-		}
-	}
-
-	return false;
+	ASTNode* func = resolve_find_function(name);
+	return func != NULL && IsBuiltinFunction(func);
 }
 
 Variable* InterpretFunctionCall(ASTNode *call) {
-	if (call->d.list == NULL || call->d.list->elem == NULL) {
-		// TODO: if function should return value, semantic error
-		return NULL; // function is empty
-	}
-
-	if (IsBuiltin(call->d.string_data)) {
+	// bound by the resolver, see resolver.h
+	ASTNode* func = call->right;
+	if (IsBuiltinFunction(func)) {
 		return InterpretBuiltinCall(call);
 	}
 
-	ASTNode* func = FindFunction(call->d.string_data);
-	if (func == NULL) {
-		throw_error(CODE_ERROR_SEMANTIC, "[Interpret] Calling function that was not defined");
-	}
-
-	// first set this to block, so we can add variables that are in the outer block
-	scope_start(scopes, SCOPE_BLOCK);
-
-	ASTList* arg = func->left->d.list;
-	for(ASTList* it = call->left->d.list; it != NULL && it->elem != NULL; it = it->next, arg = arg->next) {
-		// this is the symbol that is bein passed to the function
-		Variable* symbol = EvaluateExpression(it->elem);
-		// we need to copy this symbol to the current scope with name provided by function
-		Variable* this_symbol = gc_malloc(sizeof(Variable));
-		this_symbol->data = symbol->data;
-		this_symbol->data_type = symbol->data_type;
+	// list of statements that should be interpreted
+	// is in the right leaf of the function (resolved, so the frame size is known)
+	ASTList* list = FunctionBody(func);
+	struct frame callee = NewFrame(func);
+
+	ASTList* params = func->left->d.list;
+	ASTList* args = call->left->d.list;
+	for (int i = 0; i < args->count; i++) {
+		if (i >= params->count) {
+			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Too many arguments in function call");
+		}
+		// arguments are evaluated in the caller's frame
+		Variable* symbol = EvaluateExpression(args->elems[i]);
+		// parameter has its declared type, auto takes the type of the argument
+		enum ast_var_type type = params->elems[i]->var_type;
+		if (type == AST_VAR_AUTO) {
+			type = symbol->data_type;
+		}
+		if (!AreCompatibleTypes(type, symbol->data_type)) {
+			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Argument of incompatible type");
+		}
+		// parameters are the first slots of the callee frame
+		Variable* this_symbol = &callee.cells[params->elems[i]->index];
+		this_symbol->data = ConvertValue(symbol, type);
+		this_symbol->data_type = type;
 		this_symbol->initialized = true;
 
-		set_symbol(scopes, arg->elem->d.string_data, this_symbol);
+		callee.vars[params->elems[i]->index] = this_symbol;
 	}
 
-	// correct the scope type to function
-	((struct hash_table*)StackTop(scopes->stack))->scope_type = SCOPE_FUNCTION;
+	struct frame caller = frame;
+	frame = callee;
 
 	Variable* return_val = gc_malloc(sizeof(Variable));
-	// list of statements that should be interpreted
-	// is in the right leaf of the function
-	ASTList* list = func->right->d.list;
 	InterpretList(list, return_val);
 
-	if (!AreCompatibleTypes(return_val->data_type, func->var_type)) {
+	// the value has to fit the declared type, like an assignment
+	if (!AreCompatibleTypes(func->var_type, return_val->data_type)) {
 		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][Return] Cannot return non-compatible values");
 	}
+	return_val->data = ConvertValue(return_val, func->var_type);
+	return_val->data_type = func->var_type;
 
-	scope_end(scopes);
+	// return_val is a copy, nothing points into the frame any more
+	frame = caller;
+	free(callee.vars);
 
 	return return_val;
 }
 
+// the argument count was checked when the call was bound,
+// only the types of the values are left for the run time
 Variable *InterpretBuiltinCall(ASTNode *call) {
-	string * func_name = call->d.string_data;
-	ASTList* it = call->left->d.list;
+	const struct Builtin* builtin = &kBuiltinTable[call->right->index];
+	ASTList* args = call->left->d.list;
+	Variable* values[BUILTIN_MAX_PARAMS];
 
-	if(equals(func_name, new_str("concat")) ) {
-		return BuiltInConcat(it);
-	}
-	else if(equals(func_name, new_str("length"))) {
-		return  BuiltInLength(it);
-	}
-	else if(equals(func_name, new_str("substr"))) {
-		return BuiltInSubstr(it);
+	for (int i = 0; i < builtin->param_count; i++) {
+		values[i] = EvaluateArgument(args->elems[i]);
 	}
-	else if(equals(func_name, new_str("sort"))) {
-		return BuiltInSort(it);
-	}
-	else if(equals(func_name, new_str("find"))) {
-		return  BuiltInFind(it);
+	for (int i = 0; i < builtin->param_count; i++) {
+		if (values[i]->data_type != builtin->params[i]) {
+			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
+		}
 	}
-	return NULL;
+
+	return builtin->call(values);
 }
 
 void InterpretFor(ASTNode *node, Variable* return_val) {
-	scope_start(scopes, SCOPE_BLOCK);
 
-	ASTNode* first_block = node->d.list->elem; // first block
-	ASTNode* second_block = node->d.list->next->elem; // second block
-	ASTNode* third_block = node->d.list->next->next->elem; // third block
+	ASTNode* first_block = node->d.list->elems[0]; // first block
+	ASTNode* second_block = node->d.list->elems[1]; // second block
+	ASTNode* third_block = node->d.list->elems[2]; // third block
 
 	InterpretNode(first_block, return_val);
 
@@ -308,7 +392,6 @@ void InterpretFor(ASTNode *node, Variable* return_val) {
 	}
 
 	while(condition->data.bool_data && return_val->data_type == AST_VAR_NULL) {
-		scope_start(scopes, SCOPE_BLOCK);
 		// block is in the left node
 		InterpretList(node->left->d.list, return_val);
 
@@ -320,10 +403,7 @@ void InterpretFor(ASTNode *node, Variable* return_val) {
 		if (condition->data_type != AST_VAR_BOOL) {
 			throw_error(CODE_ERROR_SEMANTIC, "[Interpret][For] Second field expects boolean result");
 		}
-		scope_end(scopes);
 	};
-
-	scope_end(scopes);
 }
 
 enum ast_var_type GetVarTypeFromLiteral(enum ast_literal_type type) {
@@ -363,79 +443,162 @@ Variable* EvaluateExpression(ASTNode *expr) {
 		return NULL;
 	}
 
-	// unpack if the expression is packed
-	if (expr->type == AST_EXPRESSION) {
-		expr = expr->left;
+	// a bare variable is not converted, its index is the frame slot
+	if (expr->type == AST_VAR) {
+		Variable* result = FrameVariable(expr->index);
+		if (result == NULL) {
+			throw_error(CODE_ERROR_SEMANTIC, "[Interpret][Var] Variable in the expression was not found");
+		}
+		return result;
 	}
 
-	Variable* result = NULL;
+	if (expr->index == FLAT_NONE) {
+		expr->index = flat_convert(expr);
+	}
+
+	return EvaluateFlat(expr->index);
+}
 
-	// if the left expression is literal, all we do
-	// is copy the literal to the top node as a start
-	if (expr->type == AST_LITERAL) {
-		// expression is literal. Just get the literal type and return value
-		result = gc_malloc(sizeof(Variable));
-		result->data_type = GetVarTypeFromLiteral(expr->literal);
-		result->data = expr->d;
-		result->initialized = true;
-	} else if (expr->type == AST_BINARY_OP) {
-		// evaluate expressions on both sides
-		Variable *left = EvaluateExpression(expr->left);
-		Variable *right = EvaluateExpression(expr->right);
-
-		if (!AreCompatibleTypes(left->data_type, right->data_type)) {
-			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][Expression] Provided values are of different types");
+// values of the evaluated subexpressions, shared by nested
+// evaluations (function calls inside of the expressions)
+static Variable** flat_values = NULL;
+static int flat_values_top = 0;
+static int flat_values_size = 0;
+
+static void PushFlatValue(Variable* value) {
+	if (flat_values_top == flat_values_size) {
+		flat_values_size = (flat_values_size) ? flat_values_size * 2 : 64;
+		flat_values = gc_realloc(flat_values, flat_values_size * sizeof(Variable*));
+		if (flat_values == NULL) {
+			throw_error(CODE_ERROR_INTERNAL, "[Interpret] Cannot grow the value stack");
 		}
+	}
+	flat_values[flat_values_top++] = value;
+}
 
-		if (!(left->initialized && right->initialized)) {
-			throw_error(CODE_ERROR_UNINITIALIZED_ID, "[Interpret][Expression] Trying to use uninitialized variable");
+// literals are constant, so each one gets its value only once and the
+// literal's flat.left keeps the index here (comparisons widen int operands
+// to double in place, that does not change the value)
+static Variable** literal_values = NULL;
+static int literal_values_count = 0;
+static int literal_values_size = 0;
+
+static Variable* LiteralValue(int32_t i) {
+	if (flat.left[i] == FLAT_NONE) {
+		if (literal_values_count == literal_values_size) {
+			literal_values_size = (literal_values_size) ? literal_values_size * 2 : 64;
+			literal_values = gc_realloc(literal_values, literal_values_size * sizeof(Variable*));
+			if (literal_values == NULL) {
+				throw_error(CODE_ERROR_INTERNAL, "[Interpret] Cannot grow the literal values");
+			}
 		}
 
-		// expression is binary operation, calculate based on the operator
-		switch (expr->d.binary) {
-			case AST_BINARY_PLUS:
-				result = EvaluateBinaryPlus(left, right);
-				break;
-			case AST_BINARY_MINUS:
-				result = EvaluateBinaryMinus(left, right);
-				break;
-			case AST_BINARY_TIMES:
-				result = EvaluateBinaryMult(left, right);
-				break;
-			case AST_BINARY_DIVIDE:
-				result = EvaluateBinaryDivide(left, right);
-				break;
-			case AST_BINARY_LESS:
-				result = EvaluateBinaryLess(left, right);
-				break;
-			case AST_BINARY_MORE:
-				result = EvaluateBinaryMore(left, right);
+		Variable* value = gc_malloc(sizeof(Variable));
+		value->data_type = GetVarTypeFromLiteral(flat.op[i]);
+		value->data = flat.value[i];
+		value->initialized = true;
+
+		literal_values[literal_values_count] = value;
+		flat.left[i] = literal_values_count++;
+	}
+
+	return literal_values[flat.left[i]];
+}
+
+// EvaluateFlat walks the expression in postfix order, so the operands
+// are evaluated in the same order as by the recursive tree walk
+Variable* EvaluateFlat(int32_t root) {
+	int base = flat_values_top;
+
+	for (int32_t i = flat_first(root); i <= root; i++) {
+		Variable* result = NULL;
+
+		switch (flat.kind[i]) {
+			case FLAT_LITERAL:
+				// expression is literal, its value is shared by all evaluations
+				result = LiteralValue(i);
 				break;
-			case AST_BINARY_LESS_EQUALS:
-				result = EvaluateBinaryLessEqual(left, right);
+			case FLAT_VAR:
+				// the expression is variable, return the variable value
+				result = FrameVariable(flat.left[i]);
+				if (result == NULL) {
+					throw_error(CODE_ERROR_SEMANTIC, "[Interpret][Var] Variable in the expression was not found");
+				}
 				break;
-			case AST_BINARY_MORE_EQUALS:
-				result = EvaluateBinaryMoreEqual(left, right);
+			case FLAT_CALL:
+				result = InterpretFunctionCall(flat.calls[flat.left[i]]);
 				break;
-			case AST_BINARY_EQUALS:
-				result = EvaluateBinaryEqual(left,right);
+			case FLAT_BINARY: {
+				Variable* right = flat_values[--flat_values_top];
+				Variable* left = flat_values[--flat_values_top];
+				// operand types checked before the run are not checked again
+				result = (flat.op[i] & FLAT_TYPED)
+					? EvaluateOperation(flat.op[i] & ~FLAT_TYPED, left, right)
+					: EvaluateBinary(flat.op[i], left, right);
 				break;
-			case AST_BINARY_NOT_EQUALS:
-				result = EvaluateBinaryNotEqual(left, right);
+			}
+			default:
 				break;
 		}
 
-		result->initialized = true;
-	} else if (expr->type == AST_VAR) {
-		// the expression is variable, return the variable value
-		result = get_symbol(scopes, expr->d.string_data);
-		if (result == NULL) {
-			throw_error(CODE_ERROR_SEMANTIC, "[Interpret][Var] Variable in the expression was not found");
-		}
-	} else if (expr->type == AST_CALL) {
-		result = InterpretFunctionCall(expr);
+		PushFlatValue(result);
+	}
+
+	flat_values_top = base;
+	return flat_values[base];
+}
+
+Variable* EvaluateBinary(enum ast_binary_op_type op, Variable* left, Variable* right) {
+	if (!AreCompatibleTypes(left->data_type, right->data_type)) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][Expression] Provided values are of different types");
+	}
+
+	return EvaluateOperation(op, left, right);
+}
+
+// EvaluateOperation expects operands of compatible types
+Variable* EvaluateOperation(enum ast_binary_op_type op, Variable* left, Variable* right) {
+	Variable* result = NULL;
+
+	if (!(left->initialized && right->initialized)) {
+		throw_error(CODE_ERROR_UNINITIALIZED_ID, "[Interpret][Expression] Trying to use uninitialized variable");
 	}
 
+	// expression is binary operation, calculate based on the operator
+	switch (op) {
+		case AST_BINARY_PLUS:
+			result = EvaluateBinaryPlus(left, right);
+			break;
+		case AST_BINARY_MINUS:
+			result = EvaluateBinaryMinus(left, right);
+			break;
+		case AST_BINARY_TIMES:
+			result = EvaluateBinaryMult(left, right);
+			break;
+		case AST_BINARY_DIVIDE:
+			result = EvaluateBinaryDivide(left, right);
+			break;
+		case AST_BINARY_LESS:
+			result = EvaluateBinaryLess(left, right);
+			break;
+		case AST_BINARY_MORE:
+			result = EvaluateBinaryMore(left, right);
+			break;
+		case AST_BINARY_LESS_EQUALS:
+			result = EvaluateBinaryLessEqual(left, right);
+			break;
+		case AST_BINARY_MORE_EQUALS:
+			result = EvaluateBinaryMoreEqual(left, right);
+			break;
+		case AST_BINARY_EQUALS:
+			result = EvaluateBinaryEqual(left,right);
+			break;
+		case AST_BINARY_NOT_EQUALS:
+			result = EvaluateBinaryNotEqual(left, right);
+			break;
+	}
+
+	result->initialized = true;
 	return result;
 }
 
@@ -866,6 +1029,9 @@ Variable *EvaluateBinaryNotEqual(Variable *left, Variable *right) {
 }
 
 Variable * EvaluateArgument(ASTNode* arg) {
+	if(arg == NULL) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Missing argument in builtin call");
+	}
 	if(arg->type == AST_CALL) {
 		return  InterpretFunctionCall(arg);
 	}
@@ -876,91 +1042,49 @@ Variable * EvaluateArgument(ASTNode* arg) {
 	return NULL;
 }
 
-Variable * BuiltInConcat(ASTList * args) {
-	Variable* result = gc_malloc(sizeof(Variable));
-	Variable * str1 = NULL;
-	Variable * str2 = NULL;
-
-	str1 = EvaluateArgument(args->elem);
-	str2 = EvaluateArgument(args->next->elem);
+// builtins get values of the arguments already checked by InterpretBuiltinCall
 
-	if(str1->data_type !=  AST_VAR_STRING || str2->data_type != AST_VAR_STRING ) {
-		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
-	}
+Variable * BuiltInConcat(Variable ** args) {
+	Variable* result = gc_malloc(sizeof(Variable));
 
 	result->data_type= AST_VAR_STRING;
-	result->data.string_data =  new_str(concat(str1->data.string_data->str, str2->data.string_data->str));
+	result->data.string_data =  new_str(concat(args[0]->data.string_data->str, args[1]->data.string_data->str));
 	result->initialized = true;
 	return result;
 }
 
-
-Variable * BuiltInLength(ASTList * args) {
+Variable * BuiltInLength(Variable ** args) {
 	Variable * result = gc_malloc(sizeof(Variable));
-	Variable * arg = NULL;
-
-	arg = EvaluateArgument(args->elem);
-
-	if(arg->data_type !=  AST_VAR_STRING) {
-		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
-	}
 
 	result->data_type = AST_VAR_INT;
-	result->data.numeric_data = length(arg->data.string_data->str);
+	result->data.numeric_data = args[0]->data.string_data->len;
 	result->initialized = true;
 	return result;
 }
 
-Variable * BuiltInSubstr(ASTList * args) {
+Variable * BuiltInSubstr(Variable ** args) {
 	Variable * result = gc_malloc(sizeof(Variable));
-	Variable * arg1 = NULL;
-	Variable * arg2 = NULL;
-	Variable * arg3 = NULL;
-
-	arg1 = EvaluateArgument(args->elem);
-	arg2 = EvaluateArgument(args->next->elem);
-	arg3 = EvaluateArgument(args->next->next->elem);
-
-	if (arg1->data_type != AST_VAR_STRING || arg2->data_type != AST_VAR_INT || arg3->data_type != AST_VAR_INT) {
-		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type. ");
-	}
 
 	result->data_type = AST_VAR_STRING;
-	result->data.string_data = new_str( substr( arg1->data.string_data->str, (int)arg2->data.numeric_data, (int)arg3->data.numeric_data ));
+	result->data.string_data = new_str( substr( args[0]->data.string_data->str, (int)args[1]->data.numeric_data, (int)args[2]->data.numeric_data ));
 	result->initialized = true;
 	return result;
 }
 
-Variable * BuiltInSort(ASTList * args) {
+Variable * BuiltInSort(Variable ** args) {
 	Variable * result = gc_malloc(sizeof(Variable));
-	Variable * arg = NULL;
-
-	arg = EvaluateArgument(args->elem);
-
-	if(arg->data_type !=  AST_VAR_STRING) {
-		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
-	}
 
 	result->data_type = AST_VAR_STRING;
-	result->data.string_data = new_str(sort(arg->data.string_data->str));
+	result->data.string_data = new_str(sort(args[0]->data.string_data->str));
 	result->initialized = true;
 	return result;
 }
 
-Variable * BuiltInFind(ASTList * args) {
+Variable * BuiltInFind(Variable ** args) {
 	Variable* result = gc_malloc(sizeof(Variable));
-	Variable * str1 = NULL;
-	Variable * str2 = NULL;
-
-	str1 = EvaluateArgument(args->elem);
-	str2 = EvaluateArgument(args->next->elem);
-
-	if(str1->data_type !=  AST_VAR_STRING || str2->data_type != AST_VAR_STRING ) {
-		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
-	}
 
 	result->data_type= AST_VAR_INT;
-	result->data.numeric_data =  find(str1->data.string_data->str, str2->data.string_data->str);
+	result->data.numeric_data =  find(args[0]->data.string_data->str, args[1]->data.string_data->str);
 	result->initialized = true;
 
 	return result;
@@ -970,12 +1094,11 @@ Variable * BuiltInFind(ASTList * args) {
 // printed to the screen
 void InterpretCout(ASTNode *cout) {
 	ASTList* list = cout->d.list;
-	do {
+	for (int i = 0; i < list->count; i++) {
 		// this is the list of expressions
-		ASTNode* elem = list->elem;
+		ASTNode* elem = list->elems[i];
 		Variable* result = EvaluateExpression(elem);
 		if (result == NULL) {
-			list = list->next;
 			continue; // empty expression
 		}
 
@@ -1002,18 +1125,16 @@ void InterpretCout(ASTNode *cout) {
 			default:
 				throw_error(CODE_ERROR_RUNTIME_OTHER, "[Interpret] Provided var in cout not supported");
 		}
-
-		list = list->next;
-	} while (list != NULL);
+	}
 }
 
 void InterpretCin(ASTNode *cin) {
 	ASTList* list = cin->d.list; // id list
 
-	do {
-		ASTNode* elem = list->elem;
+	for (int i = 0; i < list->count; i++) {
+		ASTNode* elem = list->elems[i];
 		// find the variable that should get the input
-		Variable *variable = get_symbol(scopes, elem->d.string_data);
+		Variable *variable = FrameVariable(elem->index);
 		if (variable == NULL) {
 			throw_error(CODE_ERROR_SEMANTIC, "[Interpret] Cannot assign input to non existing variable");
 		}
@@ -1051,7 +1172,5 @@ void InterpretCin(ASTNode *cin) {
 
 		// inputed variables are always initialized if no error happened
 		variable->initialized = true;
-
-		list = list->next;
-	} while(list != NULL);
+	}
 }
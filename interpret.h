@@ -2,6 +2,7 @@
 #define INTERPRET_H
 
 #include "ast.h"
+#include "flat.h"
 
 #define ASTNode struct ast_node
 #define ASTList struct ast_list
@@ -14,9 +15,14 @@ typedef struct {
 
 /*Interpret functions*/
 
-// FindFunction will search for the given function
+// FindFunction will search for the given user function,
+// name has to be interned (see intern.h)
 ASTNode* FindFunction(string* name);
 
+// FunctionBody returns statements of the function,
+// parsing a body skipped by --lazy first
+ASTList* FunctionBody(ASTNode* func);
+
 void InterpretInit(ASTList* functions);
 
 // InterpretRun will search for the main funciton
@@ -46,8 +52,16 @@ enum ast_var_type GetVarTypeFromLiteral(enum ast_literal_type type);
 
 bool AreCompatibleTypes(enum ast_var_type t1, enum ast_var_type t2);
 
+// EvaluateExpression converts the expression to the flat
+// representation on first use (see flat.h) and evaluates it there
 Variable* EvaluateExpression(ASTNode* node);
 
+Variable* EvaluateFlat(int32_t root);
+
+Variable* EvaluateBinary(enum ast_binary_op_type op, Variable* left, Variable* right);
+
+Variable* EvaluateOperation(enum ast_binary_op_type op, Variable* left, Variable* right);
+
 Variable* EvaluateBinaryPlus(Variable* left, Variable* right);
 
 Variable* EvaluateBinaryMinus(Variable* left, Variable* right);
@@ -70,15 +84,15 @@ Variable *EvaluateBinaryNotEqual(Variable *left, Variable *right);
 
 Variable * EvaluateArgument(ASTNode* arg);
 
-Variable * BuiltInConcat(ASTList * args);
+Variable * BuiltInConcat(Variable ** args);
 
-Variable * BuiltInLength(ASTList * args);
+Variable * BuiltInLength(Variable ** args);
 
-Variable * BuiltInSubstr(ASTList * args);
+Variable * BuiltInSubstr(Variable ** args);
 
-Variable * BuiltInSort(ASTList * args);
+Variable * BuiltInSort(Variable ** args);
 
-Variable * BuiltInFind(ASTList * args);
+Variable * BuiltInFind(Variable ** args);
 
 void InterpretCout(ASTNode* cout);
 
@@ -3,12 +3,31 @@
 #include "gc.h"
 #include "interpret.h"
 #include "input.h"
+#include "scanner.h"
+#include "pipeline.h"
+#include "ast.h"
+#include "cache.h"
+#include "parallel.h"
+#include <string.h>
+#include <time.h>
 
-struct data* d;
+__thread struct data* d; // kazde vlakno parseru ma svoje (--parallel)
 
+// prepinace z prikazove radky
+static char* source_file = NULL;
+static int bench_runs = 0; // --bench-lex N: jen N-krat prolexovat soubor a vypsat statistiky
+static int use_pipeline = 0; // --pipeline: lexer bezi ve vlastnim vlakne
+static int use_pratt = 0; // --pratt: vyrazy Prattovym parserem misto precedencni tabulky
+static int mem_report = 0; // --mem-report: jen zparsovat a vypsat pamet stromu
+static int use_cache = 0; // --cache: strom z/do <zdrojak>.ifjc misto parsovani
+static int use_lazy = 0; // --lazy: tela funkci se parsuji az pri prvnim volani (syntakticka chyba v nevolane funkci se neohlasi)
+static int use_stream = 0; // --stream: tela funkci se po kontrole zahodi a parsuji az pri volani
+static int parallel_threads = -1; // --parallel N: parsovani v N vlaknech, 0 = pocet procesoru
 
 int check_params(int argc, char *argv[]);
 void make_data_structure();
+void bench_lex(int runs);
+void print_mem_report();
 
 #ifdef UNIT_TEST
 #include "test.h"
@@ -34,25 +53,56 @@ int main(int argc, char *argv[]) {
 	make_data_structure();
 
 	// otevrem soubor
-	set_input(argv[1]);
+	set_input(source_file);
+	scanner_init();
 
-#ifdef LEX_TEST
-    do {
-		get_token();
-    } while (d->token->type != EOF);
-#else
-	// parse
-	parser_prepare(d);
-	d = parser_run();
+	if (bench_runs) {
+		bench_lex(bench_runs);
+		return 0;
+	}
+
+	// platna cache nahradi cele lexovani a parsovani
+	struct ast_node* cached = (use_cache) ? cache_load(source_file) : NULL;
+	if (cached) {
+		d->tree = cached;
+	} else {
+		parser_use_pratt(use_pratt);
+		parser_use_lazy(use_lazy);
+		parser_use_stream(use_stream);
+
+		// paralelni parsovani pri chybe vrati vstup na zacatek, chybu
+		// pak nahlasi obycejny parser
+		if (parallel_threads < 0 || !parallel_parse(d, parallel_threads)) {
+			if (use_pipeline) {
+				pipeline_start();
+				parser_set_token_source(pipeline_read_lexeme);
+			}
 
-	if (d->error != CODE_OK) {
-		return 2;
+			// parse
+			parser_prepare(d);
+			d = parser_run();
+			pipeline_stop();
+		}
+
+		if (d->error != CODE_OK) {
+			return 2;
+		}
+
+		if (use_cache) {
+			cache_store(source_file, d->tree);
+		}
+	}
+
+	if (mem_report) {
+		print_mem_report();
+		return 0;
 	}
 
 	InterpretInit(d->tree->d.list);
 	// interpret the list
 	InterpretRun();
-#endif
+	flat_release();
+	ast_release();
 
 	return 0;
 }
@@ -60,7 +110,36 @@ int main(int argc, char *argv[]) {
 
 int check_params(int argc, char *argv[])
 {
-	if (argc < 2) {
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--bench-lex")) {
+			if (i + 1 >= argc || (bench_runs = atoi(argv[++i])) <= 0) {
+				return CODE_ERROR_INTERNAL;
+			}
+		} else if (!strcmp(argv[i], "--pipeline")) {
+			use_pipeline = 1;
+		} else if (!strcmp(argv[i], "--pratt")) {
+			use_pratt = 1;
+		} else if (!strcmp(argv[i], "--mem-report")) {
+			mem_report = 1;
+		} else if (!strcmp(argv[i], "--cache")) {
+			use_cache = 1;
+		} else if (!strcmp(argv[i], "--lazy")) {
+			use_lazy = 1;
+		} else if (!strcmp(argv[i], "--stream")) {
+			use_stream = 1;
+		} else if (!strcmp(argv[i], "--parallel")) {
+			if (i + 1 >= argc || (parallel_threads = atoi(argv[++i])) < 0) {
+				return CODE_ERROR_INTERNAL;
+			}
+		} else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+			// neznamy prepinac
+			return CODE_ERROR_INTERNAL;
+		} else {
+			source_file = argv[i];
+		}
+	}
+
+	if (source_file == NULL) {
 		return CODE_ERROR_INTERNAL;
 	}
 
@@ -68,6 +147,67 @@ int check_params(int argc, char *argv[])
 	return 0;
 }
 
+// mereni lexeru: runs-krat projde cely soubor a vypise rychlost,
+// pocet alokaci a cetnosti jednotlivych typu tokenu (viz bench.sh)
+void bench_lex(int runs)
+{
+	long histogram[LEX_TYPE_COUNT];
+	long tokens = 0;
+	long allocations = gc_allocations();
+	double seconds = 0;
+	double megabytes = (double)(input_end - input_start) / (1024 * 1024);
+
+	for (int run = 1; run <= runs; run++) {
+		long run_tokens = 0;
+		memset(histogram, 0, sizeof(histogram));
+		rewind_input();
+
+		clock_t start = clock();
+		do {
+			get_token();
+			histogram[d->token->type]++;
+			run_tokens++;
+		} while (d->token->type != END_OF_FILE);
+		double run_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		printf("run %d: %ld tokens in %.3f s\n", run, run_tokens, run_seconds);
+		tokens += run_tokens;
+		seconds += run_seconds;
+	}
+	allocations = gc_allocations() - allocations;
+
+	if (seconds <= 0) {
+		seconds = 1.0 / CLOCKS_PER_SEC;
+	}
+	printf("total: %ld tokens, %.2f MB in %.3f s\n", tokens, megabytes * runs, seconds);
+	printf("throughput: %.0f tokens/s, %.1f MB/s\n", tokens / seconds, megabytes * runs / seconds);
+	printf("allocations: %ld (%.4f per token)\n", allocations, (double)allocations / tokens);
+
+	// cetnosti z posledniho behu (vsechny behy jsou stejne)
+	printf("tokens per run by type:\n");
+	for (int type = 0; type < LEX_TYPE_COUNT; type++) {
+		if (histogram[type]) {
+			printf("  %-16s %10ld  %5.1f %%\n", token_name(type), histogram[type],
+				100.0 * histogram[type] * runs / tokens);
+		}
+	}
+}
+
+// pamet stromu po parsovani vztazena k velikosti zdrojaku
+void print_mem_report()
+{
+	long source = (long)(input_end - input_start);
+	long nodes = ast_node_count();
+	long leaves = ast_leaf_count();
+	size_t bytes = ast_memory_used();
+
+	printf("source: %ld bytes\n", source);
+	printf("ast nodes: %ld interior (%zu bytes), %ld leaves (%zu bytes)\n",
+		nodes - leaves, sizeof(struct ast_node), leaves, AST_LEAF_SIZE);
+	printf("ast arena: %zu bytes, %.2f bytes per source byte\n", bytes,
+		source ? (double)bytes / source : 0.0);
+}
+
 // alokuje a zabezpeci sdilenou datovou strukturu
 void make_data_structure()
 {
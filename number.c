@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include "number.h"
+#include "scanner.h"
+
+#define MAX_MANTISSA_DIGITS 19 // vejde se do uint64 bez preteceni
+#define MAX_EXACT_MANTISSA (1ULL << 53) // cela cisla presne reprezentovatelna v double
+#define MAX_EXACT_POWER 22 // 10^22 je nejvetsi presne reprezentovatelna mocnina 10
+
+static const double exact_powers[MAX_EXACT_POWER + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+int parse_int(const char* txt, int len) {
+	// atoi je (int)strtol - pri preteceni se saturuje na LONG_MAX
+	unsigned long value = 0;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		unsigned digit = (unsigned)(txt[i] - '0');
+		if (value > ((unsigned long)LONG_MAX - digit) / 10) {
+			value = LONG_MAX;
+			break;
+		}
+		value = value * 10 + digit;
+	}
+
+	return (int)(long)value;
+}
+
+// pomala cesta - literal uz prosel scannerem, takze strtod precte cely
+static double parse_double_slow(const char* txt, int len) {
+	char buffer[CHUNK];
+	memcpy(buffer, txt, (size_t)len);
+	buffer[len] = 0;
+	return strtod(buffer, NULL);
+}
+
+double parse_double(const char* txt, int len) {
+	unsigned long long mantissa = 0;
+	int digits = 0; // platne cislice v mantise (bez uvodnich nul)
+	int exponent = 0; // desitkovy exponent mantisy
+	int exp_value = 0, exp_negative = 0;
+	int i = 0;
+
+	for (; i < len && txt[i] >= '0' && txt[i] <= '9'; i++) {
+		if (mantissa || txt[i] != '0') {
+			mantissa = mantissa * 10 + (unsigned)(txt[i] - '0');
+			if (++digits > MAX_MANTISSA_DIGITS)
+				return parse_double_slow(txt, len);
+		}
+	}
+	if (i < len && txt[i] == '.') {
+		for (i++; i < len && txt[i] >= '0' && txt[i] <= '9'; i++) {
+			if (mantissa || txt[i] != '0') {
+				mantissa = mantissa * 10 + (unsigned)(txt[i] - '0');
+				if (++digits > MAX_MANTISSA_DIGITS)
+					return parse_double_slow(txt, len);
+			}
+			exponent--;
+		}
+	}
+	if (i < len && (txt[i] == 'e' || txt[i] == 'E')) {
+		i++;
+		if (txt[i] == '+' || txt[i] == '-')
+			exp_negative = (txt[i++] == '-');
+		for (; i < len; i++) {
+			if (exp_value < 100000) // dal uz je vysledek stejne 0 nebo inf
+				exp_value = exp_value * 10 + (txt[i] - '0');
+		}
+	}
+	exponent += (exp_negative) ? -exp_value : exp_value;
+
+	if (mantissa == 0)
+		return 0.0;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	// Clingerova rychla cesta: mantisa i mocnina jsou v double presne, takze
+	// jedina operace nasobeni/deleni je spravne zaokrouhlena jako strtod
+	if (mantissa <= MAX_EXACT_MANTISSA) {
+		if (exponent >= 0 && exponent <= MAX_EXACT_POWER)
+			return (double)mantissa * exact_powers[exponent];
+		if (exponent < 0 && exponent >= -MAX_EXACT_POWER)
+			return (double)mantissa / exact_powers[-exponent];
+	}
+#endif
+
+	return parse_double_slow(txt, len);
+}
@@ -0,0 +1,9 @@
+#ifndef NUMBER_H
+#define NUMBER_H
+
+// Prevod ciselnych literalu primo z textu zdrojaku (bez kopirovani a bez
+// zavislosti na locale). Vysledky jsou bitove stejne jako atoi/strtod.
+int parse_int(const char* txt, int len); // jen cislice, preteceni jako atoi
+double parse_double(const char* txt, int len); // cislice [. cislice] [e [+-] cislice]
+
+#endif
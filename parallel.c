@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+#include "parser.h"
+#include "input.h"
+#include "intern.h"
+#include "errors.h"
+#include "ast.h"
+
+#define PARALLEL_MAX_THREADS 64
+#define PARALLEL_MIN_CHUNK 16384 // mensi kus nestoji za vlastni vlakno
+
+struct chunk {
+	const unsigned char *begin, *end;
+	pthread_t thread;
+	int started;
+	int ok;
+	struct data data; // vlastni struct data parseru ve vlakne
+	struct ast_memory memory; // arena vlakna, prevezme ji hlavni vlakno
+	struct error_trap trap;
+};
+
+static const unsigned char *source_start;
+
+// rozdeli zbytek vstupu na nejvyse count kusu, hranice jsou jen za '}'
+// na nejvyssi urovni; 0 pokud zavorky nesedi (chybu najde parser)
+static int split_source(struct chunk *chunks, int count) {
+	const unsigned char *start = input_pos;
+	long target = (input_end - input_pos) / count;
+	int n = 0, c;
+
+	if (target < PARALLEL_MIN_CHUNK)
+		target = PARALLEL_MIN_CHUNK;
+
+	chunks[0].begin = start;
+	while ((c = next_brace()) != EOF) {
+		if (c == '}' || !skip_braces()) {
+			input_pos = start;
+			return 0;
+		}
+		if (n + 1 < count && input_pos - chunks[n].begin >= target) {
+			chunks[n].end = input_pos;
+			chunks[++n].begin = input_pos;
+		}
+	}
+	chunks[n].end = input_end;
+
+	input_pos = start;
+	return n + 1;
+}
+
+static void *parse_chunk(void *arg) {
+	struct chunk *chunk = arg;
+
+	input_start = source_start;
+	input_pos = chunk->begin;
+	input_end = chunk->end;
+
+	set_error_trap(&chunk->trap);
+	if (setjmp(chunk->trap.jump) == 0) {
+		parser_prepare(&chunk->data);
+		parser_run();
+		chunk->ok = (chunk->data.error == CODE_OK);
+	}
+	set_error_trap(NULL);
+
+	parser_release();
+	ast_detach(&chunk->memory);
+	return NULL;
+}
+
+bool parallel_parse(struct data* data, int threads) {
+	static struct chunk chunks[PARALLEL_MAX_THREADS];
+	int count, i, j, ok = 1;
+
+	if (threads <= 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (int)cpus : 1;
+	}
+	if (threads > PARALLEL_MAX_THREADS)
+		threads = PARALLEL_MAX_THREADS;
+
+	memset(chunks, 0, sizeof(chunks));
+	if ((count = split_source(chunks, threads)) < 2)
+		return false;
+
+	source_start = input_start;
+	intern_set_shared(1);
+	input_set_shared(1);
+	for (i = 0; i < count; i++) {
+		chunks[i].data = *data;
+		chunks[i].data.error = CODE_OK;
+		chunks[i].data.token = NULL;
+		chunks[i].started = !pthread_create(&chunks[i].thread, NULL, parse_chunk, &chunks[i]);
+	}
+	for (i = 0; i < count; i++) {
+		if (chunks[i].started)
+			pthread_join(chunks[i].thread, NULL);
+		ok = ok && chunks[i].ok;
+		// pamet se prevezme vzdy, uvolni ji az ast_release
+		ast_attach(&chunks[i].memory);
+	}
+	intern_set_shared(0);
+	input_set_shared(0);
+
+	if (!ok)
+		return false;
+
+	parser_prepare(data);
+	for (i = 0; i < count; i++) {
+		struct ast_list *functions = chunks[i].data.tree->d.list;
+		for (j = 0; j < functions->count; j++)
+			ast_list_insert(data->tree->d.list, functions->elems[j]);
+	}
+	input_pos = input_end;
+
+	return true;
+}
@@ -0,0 +1,15 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdbool.h>
+#include "common.h"
+
+// Parsovani ve vice vlaknech (--parallel N). Zdrojak se bez lexeru rozdeli
+// na konci definic funkci na N zhruba stejnych kusu, kazdy kus zparsuje
+// vlastni vlakno do vlastni areny a AST_FUNCTION uzly se pak spoji ve
+// stejnem poradi jako ve zdrojaku. Pokud se nejaky kus nepovede, vrati
+// false a vstup je zpet na zacatku - sekvencni parser pak nahlasi stejnou
+// chybu jako bez --parallel.
+bool parallel_parse(struct data* data, int threads); // threads 0 = pocet procesoru
+
+#endif
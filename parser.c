@@ -4,10 +4,15 @@
 #include "gc.h"
 #include "scanner.h"
 #include "ast.h"
-#include "stack.h"
+#include "input.h"
 
 #define PRINT 0
 
+// kruhovy buffer tokenu - aktualni token plus az TOKEN_RING_SIZE - 1 tokenu
+// dopredu (peek_token), sloty se pouzivaji znovu, takze parsovani nealokuje
+#define TOKEN_RING_SIZE 8 // mocnina dvojky
+#define TOKEN_RING_MASK (TOKEN_RING_SIZE - 1)
+
 bool expect(enum lex_type t);
 bool accept(enum lex_type t);
 
@@ -47,20 +52,75 @@ bool parse_for(struct ast_node* node);
 bool parse_assign(struct ast_node* node);
 bool handle_id(struct ast_node* node);
 
-struct data* d;
+extern __thread struct data* d;
+
+
+// stav parseru je pro kazde vlakno zvlast (--parallel), prepinace jsou spolecne
+static __thread struct lexeme token_ring[TOKEN_RING_SIZE];
+static __thread int ring_current = 0; // slot aktualniho tokenu (d->token)
+static __thread int ring_ahead = 0; // kolik tokenu za aktualnim uz je nactenych
+static __thread struct lexeme (*token_source)(void) = read_lexeme; // odkud se berou tokeny
+static bool use_pratt = false; // vyrazy Prattovym parserem misto precedencni tabulky
+static bool lazy_bodies = false; // tela funkci se parsuji az pri prvnim volani
+static bool stream_bodies = false; // tela funkci se zkontroluji a zahodi, viz parse_streamed_body
+
+void parser_set_token_source(struct lexeme (*source)(void))
+{
+    token_source = source;
+}
+
+void parser_use_pratt(bool enable)
+{
+    use_pratt = enable;
+}
+
+void parser_use_lazy(bool enable)
+{
+    lazy_bodies = enable;
+}
+
+void parser_use_stream(bool enable)
+{
+    stream_bodies = enable;
+}
 
+// nacte dalsi lexem do slotu, puvodni obsah slotu se uvolni
+static void fill_slot(int slot)
+{
+    free_token(&token_ring[slot]);
+    token_ring[slot] = token_source();
+}
 
 // interfacova lahudka
 void get_token()
 {
-    struct lexeme token = read_lexeme();
-    // takhle je to potreba delat, protoze jinak se ccko z tech pointeru zblazni
-    d->token = (struct lexeme*)malloc(sizeof(struct lexeme));
-    d->token->type = token.type;
-    d->token->value = token.value;
+    ring_current = (ring_current + 1) & TOKEN_RING_MASK;
+    if (ring_ahead > 0) {
+        // token uz byl nacteny pres peek_token
+        ring_ahead--;
+    } else {
+        fill_slot(ring_current);
+    }
+
+    d->token = &token_ring[ring_current];
     if (PRINT) printf("\tLEXER: got token of type %i\n", d->token->type);
 }
 
+// vrati k-ty token za aktualnim (1 = nasledujici), aktualni token se nemeni
+struct lexeme* peek_token(int k)
+{
+    if (k < 1 || k >= TOKEN_RING_SIZE) {
+        throw_error(CODE_ERROR_INTERNAL, "token lookahead out of range");
+    }
+
+    while (ring_ahead < k) {
+        ring_ahead++;
+        fill_slot((ring_current + ring_ahead) & TOKEN_RING_MASK);
+    }
+
+    return &token_ring[(ring_current + k) & TOKEN_RING_MASK];
+}
+
 
 struct data* parser_run()
 {
@@ -280,6 +340,7 @@ bool parse_for(struct ast_node* node)
     ast_list_insert(node->d.list, third_field);
 
     node->type = AST_FOR;
+    block->type = AST_BLOCK;
     node->left = block;
 
     return true;
@@ -349,6 +410,83 @@ bool parse_cin(struct ast_node* node)
     return true;
 }
 
+// --stream: telo se zparsuje cele (chyby jsou stejne jako bez --stream),
+// ale do docasne areny, ktera se hned zahodi; ve strome zustane jen
+// AST_LAZY_BODY a pri prvnim volani se telo zparsuje znovu. Pamet parseru
+// je tak dana nejvetsi funkci, ne celym zdrojakem; prectena cast
+// namapovaneho vstupu se muze vratit systemu.
+static bool parse_streamed_body(struct ast_node* body)
+{
+    int offset = d->token->offset;
+    bool ok;
+
+    ast_scratch_begin();
+    ok = token_left_brace() && parse_program_block(body) && token_right_brace();
+    ast_scratch_end();
+    EXPECT(ok);
+
+    body->type = AST_LAZY_BODY;
+    body->d.offset = offset;
+    body->left = body->right = NULL;
+    input_release_before(input_start + d->token->offset);
+
+    return true;
+}
+
+// --lazy: z tela se zapamatuje jen pozice '{' a preskoci se po znacich
+// k odpovidajici '}' (zavorky v retezcich a komentarich se nepocitaji).
+// Telo projde jen lexer, aby lexikalni chyba (1) byla stejna jako bez
+// --lazy; syntakticke chyby uvnitr se projevi az v parser_parse_body.
+// Kdyz odpovidajici '}' neni, vrati false a vstup necha na miste.
+static bool skip_function_body(struct ast_node* body)
+{
+    const unsigned char* start = input_start + d->token->offset + 1; // za '{'
+
+    input_pos = start;
+    if (!skip_braces()) {
+        input_pos = start;
+        return false;
+    }
+
+    const unsigned char* end = input_pos;
+    input_pos = start;
+    while (input_pos < end) {
+        struct lexeme token = read_lexeme();
+        free_token(&token);
+    }
+    input_pos = end;
+
+    body->type = AST_LAZY_BODY;
+    body->d.offset = d->token->offset;
+
+    // token za telem
+    get_token();
+    return true;
+}
+
+bool parser_parse_body(struct ast_node* body)
+{
+    struct lexeme (*source)(void) = token_source;
+
+    if (body->type != AST_LAZY_BODY) {
+        return true;
+    }
+
+    // lexer zacne znovu od '{' tela, rozectene tokeny se zahodi
+    token_source = read_lexeme;
+    input_pos = input_start + body->d.offset;
+    ring_ahead = 0;
+    get_token();
+
+    bool ok = token_left_brace() && parse_program_block(body) && token_right_brace();
+    token_source = source;
+    if (ok) {
+        body->type = AST_BODY;
+    }
+
+    return ok;
+}
+
 bool parse_function_definition(struct ast_node* node)
 {
     if (PRINT) printf("\tparser: parsing function definition\n");
@@ -365,9 +503,18 @@ bool parse_function_definition(struct ast_node* node)
 
     EXPECT(parse_function_arguments(arguments));
 
-    EXPECT(token_left_brace());
-    EXPECT(parse_program_block(body));
-    EXPECT(token_right_brace());
+    // preskakuje se primo ve zdrojaku, takze jen s lexerem v tomto vlakne
+    // (neuzavrene telo se parsuje hned, aby chyba byla stejna jako bez --lazy)
+    if (lazy_bodies && token_source == read_lexeme && ring_ahead == 0 && accept(LBR)
+        && skip_function_body(body)) {
+        EXPECT(no_errors());
+    } else if (stream_bodies && accept(LBR)) {
+        EXPECT(parse_streamed_body(body));
+    } else {
+        EXPECT(token_left_brace());
+        EXPECT(parse_program_block(body));
+        EXPECT(token_right_brace());
+    }
 
     // poskladame
     node->type = AST_FUNCTION;
@@ -398,6 +545,7 @@ bool parse_function_arguments(struct ast_node* node)
         struct ast_node * variable = ast_create_node();
         variable->type = AST_VAR;
         variable->d.string_data = var_name;
+        variable->var_type = *var_type;
         // zalozime do seznamu argumentu
         ast_list_insert(node->d.list, variable);
         // tohle je ta pumping lemma - pumpujeme kombinaci ",datatype id"
@@ -412,6 +560,7 @@ bool parse_function_arguments(struct ast_node* node)
             struct ast_node * variable = ast_create_node();
             variable->type = AST_VAR;
             variable->d.string_data = var_name;
+            variable->var_type = *var_type;
             // zalozime do seznamu argumentu
             ast_list_insert(node->d.list, variable);
         }
@@ -477,7 +626,33 @@ bool IsOperatorNode(struct ast_node* node) {
 // populated with the non-expression token, it will return
 // null instead
 struct ast_node* GetASTNodeFromToken(struct lexeme* lex) {
-    struct ast_node* node = ast_create_node();
+    struct ast_node* node;
+
+    switch(lex->type) {
+        case DOUBLE:
+        case INTEGER:
+        case STRING:
+            // literal nema potomky
+            node = ast_create_leaf();
+            break;
+        case PLUS:
+        case MINUS:
+        case MULT:
+        case DIVIDE:
+        case LT:
+        case GT:
+        case LTE:
+        case GTE:
+        case EQ:
+        case NEQ:
+        case LPAR:
+        case RPAR:
+        case IDENTIFIER:
+            node = ast_create_node();
+            break;
+        default:
+            return NULL; // token is not from the expression tokens
+    }
 
     switch(lex->type) {
         case DOUBLE:
@@ -493,7 +668,7 @@ struct ast_node* GetASTNodeFromToken(struct lexeme* lex) {
         case STRING:
             node->type = AST_LITERAL;
             node->literal = AST_LITERAL_STRING;
-            node->d.string_data = new_str(lex->value.string);
+            node->d.string_data = ast_create_string(lexeme_text(lex), lex->length);
         break;
         case PLUS:
             node->type = AST_BINARY_OP;
@@ -536,7 +711,7 @@ struct ast_node* GetASTNodeFromToken(struct lexeme* lex) {
 
         case IDENTIFIER:
             node->type = AST_VAR;
-            node->d.string_data = new_str(lex->value.string);
+            node->d.string_data = lex->value.symbol;
         break;
         case EQ:
             node->type = AST_BINARY_OP;
@@ -582,35 +757,93 @@ char GetPrecendence(struct ast_node* stacked, struct ast_node* next) {
     return PrecendenceTable[GetASTNodePrecendenceValue(stacked)][GetASTNodePrecendenceValue(next)];
 }
 
+// Zasobnik precedencni analyzy. Jedno pole sdilene vsemi volanimi
+// parse_expression - vnorene volani (argumenty funkce) pracuje nad
+// polozkami od sveho base. Kazda polozka si pamatuje index nejvyssiho
+// operatoru pod sebou, takze GetStackTopOperator je O(1).
+#define EXPR_STACK_INITIAL 256
+
+struct expr_entry {
+    struct ast_node* node;
+    int top_operator; // index nejvyssiho operatoru v base..tato polozka, -1 zadny
+};
+
+typedef struct {
+    int base; // prvni polozka tohoto volani
+} ExprStack;
+
+static __thread struct expr_entry* expr_entries = NULL;
+static __thread int expr_top = 0; // prvni volna polozka
+static __thread int expr_capacity = 0;
+
+static void ExprStackInit(ExprStack* stack) {
+    stack->base = expr_top;
+}
+
+// uvolni polozky volani (i pri predcasnem navratu)
+static void ExprStackFree(ExprStack* stack) {
+    expr_top = stack->base;
+}
+
+static bool ExprStackEmpty(ExprStack* stack) {
+    return expr_top == stack->base;
+}
+
+static int ExprStackSize(ExprStack* stack) {
+    return expr_top - stack->base;
+}
+
+static void ExprStackPush(ExprStack* stack, struct ast_node* node) {
+    if (expr_top == expr_capacity) {
+        expr_capacity = (expr_capacity) ? expr_capacity * 2 : EXPR_STACK_INITIAL;
+        expr_entries = gc_realloc(expr_entries, expr_capacity * sizeof(struct expr_entry));
+        if (expr_entries == NULL) {
+            throw_error(CODE_ERROR_INTERNAL, "cannot grow expression stack");
+        }
+    }
+
+    struct expr_entry* entry = &expr_entries[expr_top];
+    entry->node = node;
+    if (IsOperatorNode(node)) {
+        entry->top_operator = expr_top;
+    } else {
+        entry->top_operator = (expr_top > stack->base) ? expr_entries[expr_top - 1].top_operator : -1;
+    }
+    expr_top++;
+}
+
+static struct ast_node* ExprStackPop(ExprStack* stack) {
+    if (ExprStackEmpty(stack)) {
+        return NULL;
+    }
+    return expr_entries[--expr_top].node;
+}
+
+static struct ast_node* ExprStackTop(ExprStack* stack) {
+    if (ExprStackEmpty(stack)) {
+        return NULL;
+    }
+    return expr_entries[expr_top - 1].node;
+}
+
 // GetStackTopOperator returns top-most operator from the
 // given stack of ast_node. This must be implemented because
 // of the precendence matching mechanism and due to missing
 // output stack (as we are creating ast tree instead)
-struct ast_node* GetStackTopOperator(Stack *stack, bool bracket) {
-
-    // get the top element from the stack so we can interate over it
-    Element *el = StackTopElement(stack);
-
-    // find the top operator on the stack
-    while(el != NULL) {
-        struct ast_node* node = el->value;
-        if (IsOperatorNode(node)) {
-            // return null if the first found operator in the stack is not bracket
-            if (!bracket || (bracket && (node->type != AST_LEFT_BRACKET || node->type != AST_RIGHT_BRACKET))) {
-                return node;
-            }
-        }
-
-        el = el->next;
+struct ast_node* GetStackTopOperator(ExprStack *stack) {
+    if (ExprStackEmpty(stack)) {
+        return NULL;
     }
 
-    return NULL; // no type
+    int top = expr_entries[expr_top - 1].top_operator;
+    return (top < 0) ? NULL : expr_entries[top].node;
 }
 
 bool parse_function_call(struct ast_node* node) {
     node->type = AST_CALL;
 
     struct ast_node* args = ast_create_node();
+    args->type = AST_FUNCTION_ARGUMENTS;
     args->d.list = ast_create_list();
 
     node->left = args;
@@ -633,16 +866,17 @@ bool parse_function_call(struct ast_node* node) {
     return true;
 }
 
+// Precedencni analyza nad tabulkou PrecendenceTable (vychozi parser).
 // Node passed to this function will automacially become
 // expression node, which will store the expression in the
 // left leaf. This is beacause of empty expressions parsing
-bool parse_expression(struct ast_node* node) {
+static bool parse_expression_table(struct ast_node* node) {
     if ( PRINT ) printf("\tparser: parsing expression\n");
 
     node->type = AST_EXPRESSION;
 
-    Stack stack;
-    StackInit(&stack);
+    ExprStack stack;
+    ExprStackInit(&stack);
 
     enum ast_node_type stackType = AST_NONE;
     struct ast_node* source1 = NULL, *source2 = NULL, *result = NULL, *next_node = NULL;
@@ -653,32 +887,33 @@ bool parse_expression(struct ast_node* node) {
 
     do { // until $ on all stacks
         // next_node is not in the
-        if (next_node == NULL && StackEmpty(&stack)) {
+        if (next_node == NULL && ExprStackEmpty(&stack)) {
+            ExprStackFree(&stack);
             return true;
         }
 
         // we should parse the function here
-        if (!StackEmpty(&stack) && ((struct ast_node*)StackTop(&stack))->type == AST_VAR && next_node != NULL && next_node->type == AST_LEFT_BRACKET) {
+        if (!ExprStackEmpty(&stack) && ExprStackTop(&stack)->type == AST_VAR && next_node != NULL && next_node->type == AST_LEFT_BRACKET) {
             expect(LPAR);
             // parse the function call from the node on the top of the stack
-            struct ast_node* fnc_node = StackPop(&stack);
+            struct ast_node* fnc_node = ExprStackPop(&stack);
             parse_function_call(fnc_node);
 
             // override the next node by the whole func call
             next_node = fnc_node;
         } else {
-            if (GetStackTopOperator(&stack, true) == NULL && accept(RPAR)) {
+            if (GetStackTopOperator(&stack) == NULL && accept(RPAR)) {
                 if (PRINT) printf("\texpr parser: found right par next_node is null\n");
                 next_node = NULL;
             }
         }
 
-        char precendenceCharacter = GetPrecendence(GetStackTopOperator(&stack, false), next_node);
+        char precendenceCharacter = GetPrecendence(GetStackTopOperator(&stack), next_node);
 
         switch(precendenceCharacter) {
             case '=':
             case '<': {
-                StackPush(&stack, next_node);
+                ExprStackPush(&stack, next_node);
 
                 if (next_node->type != AST_CALL) {
                     // prepare the next token of the expression
@@ -688,7 +923,7 @@ bool parse_expression(struct ast_node* node) {
                 break;
             }
             case '>': {
-                struct ast_node* current = StackPop(&stack);
+                struct ast_node* current = ExprStackPop(&stack);
 
                 if (current != NULL && current->type != AST_RIGHT_BRACKET) {
                     //// E -> E1 op E2 ////
@@ -697,10 +932,13 @@ bool parse_expression(struct ast_node* node) {
                     source2 = current;
 
                     // pop operator from the stack
-                    result = StackPop(&stack);
+                    result = ExprStackPop(&stack);
+                    if (result == NULL || result->type != AST_BINARY_OP) {
+                        throw_error(CODE_ERROR_SYNTAX, "");
+                    }
 
                     // get first source
-                    source1 = StackPop(&stack);
+                    source1 = ExprStackPop(&stack);
 
                     // add leafs to the result
                     result->left = source1;
@@ -708,9 +946,9 @@ bool parse_expression(struct ast_node* node) {
 
                 } else if (current != NULL) {
                     //// E -> (E) ////
-                    result = StackPop(&stack);
+                    result = ExprStackPop(&stack);
 
-                    current = StackPop(&stack);
+                    current = ExprStackPop(&stack);
                     // last bracket must be left
                     if (current == NULL || current->type != AST_LEFT_BRACKET) {
                         throw_error(CODE_ERROR_SYNTAX, "");
@@ -719,17 +957,17 @@ bool parse_expression(struct ast_node* node) {
                     throw_error(CODE_ERROR_SYNTAX, "");
                 }
 
-                StackPush(&stack, result);
+                ExprStackPush(&stack, result);
                 break;
             }
             case '$':
-                if (StackTop(&stack) == NULL || StackSize(&stack) > 1) {
+                if (ExprStackTop(&stack) == NULL || ExprStackSize(&stack) > 1) {
                     throw_error(CODE_ERROR_SYNTAX, "");
                 }
 
                 // save the result to the left node of the expression
-                if (IsExpressionNode(StackTop(&stack))) {
-                    node->left = StackPop(&stack);
+                if (IsExpressionNode(ExprStackTop(&stack))) {
+                    node->left = ExprStackPop(&stack);
                 }
 
             break;
@@ -740,14 +978,176 @@ bool parse_expression(struct ast_node* node) {
             break;
         }
 
-    } while(!StackEmpty(&stack) || next_node != NULL);
+    } while(!ExprStackEmpty(&stack) || next_node != NULL);
 
+    ExprStackFree(&stack);
 
     if ( PRINT ) printf("\tparser: finished parsing expression\n");
 
     return true;
 }
 
+// Pratt (top-down operator precedence) parser - stavi stejne stromy
+// AST_BINARY_OP/AST_CALL jako tabulka, ale uzly vytvari jen pro
+// operandy a operatory. Misto rekurze ma kazde rozpracovane volani
+// (vyraz v zavorkach, pravy operand operatoru) ramec ve sdilenem poli,
+// takze hloubku zavorek omezuje jen pamet; vnorene volani (argumenty
+// funkce) pracuje nad ramci od sveho base jako ExprStack.
+#define PRATT_STACK_INITIAL 64
+
+enum pratt_kind {
+    PRATT_TOP, // cely vyraz
+    PRATT_PAREN, // vyraz v zavorkach, je operandem ramce pod sebou
+    PRATT_RIGHT // pravy operand operatoru ramce pod sebou
+};
+
+struct pratt_frame {
+    enum pratt_kind kind;
+    int min_power; // nejmensi vazebna sila operatoru, ktery ramec bere
+    struct ast_node* operator; // ceka na pravy operand z ramce nad sebou
+};
+
+static __thread struct pratt_frame* pratt_frames = NULL;
+static __thread int pratt_top = 0; // prvni volny ramec
+static __thread int pratt_capacity = 0;
+
+static void PrattPush(enum pratt_kind kind, int min_power) {
+    if (pratt_top == pratt_capacity) {
+        pratt_capacity = (pratt_capacity) ? pratt_capacity * 2 : PRATT_STACK_INITIAL;
+        pratt_frames = gc_realloc(pratt_frames, pratt_capacity * sizeof(struct pratt_frame));
+        if (pratt_frames == NULL) {
+            throw_error(CODE_ERROR_INTERNAL, "cannot grow expression stack");
+        }
+    }
+
+    pratt_frames[pratt_top].kind = kind;
+    pratt_frames[pratt_top].min_power = min_power;
+    pratt_frames[pratt_top].operator = NULL;
+    pratt_top++;
+}
+
+// vazebna sila binarniho operatoru (odpovida PrecendenceTable),
+// 0 = token neni binarni operator
+static int PrattBindingPower(enum lex_type type) {
+    switch (type) {
+        case MULT:
+        case DIVIDE:
+            return 3;
+        case PLUS:
+        case MINUS:
+            return 2;
+        case LT:
+        case GT:
+        case LTE:
+        case GTE:
+        case EQ:
+        case NEQ:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// operand: literal, promenna nebo volani funkce (zavorky resi
+// PrattExpression); NULL pokud aktualni token operand nezacina
+static struct ast_node* PrattOperand() {
+    struct ast_node* operand = NULL;
+
+    switch (d->token->type) {
+        case IDENTIFIER:
+            if (peek_token(1)->type == LPAR) {
+                operand = GetASTNodeFromToken(d->token);
+                get_token();
+                get_token();
+                parse_function_call(operand);
+            } else {
+                // promenna je list
+                operand = ast_create_leaf();
+                operand->type = AST_VAR;
+                operand->d.string_data = d->token->value.symbol;
+                get_token();
+            }
+            break;
+        case INTEGER:
+        case DOUBLE:
+        case STRING:
+            operand = GetASTNodeFromToken(d->token);
+            get_token();
+            break;
+        default:
+            break;
+    }
+
+    return operand;
+}
+
+// vyraz, NULL pokud je prazdny; vsechny operatory jsou leve
+// asociativni, takze pravy operand se bere o stupen vys
+static struct ast_node* PrattExpression() {
+    int base = pratt_top;
+    PrattPush(PRATT_TOP, 1);
+
+    for (;;) {
+        // operand ramce na vrcholu
+        if (d->token->type == LPAR) {
+            get_token();
+            PrattPush(PRATT_PAREN, 1);
+            continue;
+        }
+        struct ast_node* value = PrattOperand();
+        if (value == NULL) {
+            if (pratt_top - base > 1) {
+                throw_error(CODE_ERROR_SYNTAX, "");
+            }
+            pratt_top = base;
+            return NULL;
+        }
+
+        // operatory ramce na vrcholu; hotovy ramec preda vysledek nize
+        for (;;) {
+            struct pratt_frame* frame = &pratt_frames[pratt_top - 1];
+            int power = PrattBindingPower(d->token->type);
+
+            if (power >= frame->min_power) {
+                frame->operator = GetASTNodeFromToken(d->token);
+                frame->operator->left = value;
+                get_token();
+                PrattPush(PRATT_RIGHT, power + 1);
+                break;
+            }
+
+            pratt_top--;
+            if (frame->kind == PRATT_TOP) {
+                return value;
+            }
+            if (frame->kind == PRATT_PAREN) {
+                if (!accept(RPAR)) {
+                    throw_error(CODE_ERROR_SYNTAX, "");
+                }
+                get_token();
+            } else {
+                struct ast_node* operator = pratt_frames[pratt_top - 1].operator;
+                operator->right = value;
+                value = operator;
+            }
+        }
+    }
+}
+
+static bool parse_expression_pratt(struct ast_node* node) {
+    if ( PRINT ) printf("\tparser: parsing expression (pratt)\n");
+
+    node->type = AST_EXPRESSION;
+    // prazdny vyraz nechava left NULL stejne jako tabulka
+    node->left = PrattExpression();
+
+    return true;
+}
+
+bool parse_expression(struct ast_node* node) {
+    return (use_pratt) ? parse_expression_pratt(node) : parse_expression_table(node);
+}
+
 bool parse_if(struct ast_node* node)
 {
     if (PRINT) printf("\tparser: parsing if\n");
@@ -776,6 +1176,7 @@ bool parse_if(struct ast_node* node)
     // poskladame
     node->type = AST_IF;
     node->d.condition = condition;
+    if_body->type = else_body->type = AST_BLOCK;
     node->left = if_body;
     node->right = else_body;
 
@@ -809,6 +1210,10 @@ bool handle_id(struct ast_node* node)
     // leva zavorka za idckem znaci, ze slo o funkci
     if (accept(LPAR)) {
         id->type = AST_CALL;
+        struct ast_node* args = ast_create_node();
+        args->type = AST_FUNCTION_ARGUMENTS;
+        args->d.list = ast_create_list();
+        id->left = args;
         EXPECT(token_left_par());
         // nacteme parametry volani
         while (! accept(RPAR)) {
@@ -819,7 +1224,7 @@ bool handle_id(struct ast_node* node)
             variable->type = AST_VAR;
             variable->d.string_data = var_name;
             // zalozime do seznamu argumentu
-            ast_list_insert(id->d.list, variable);
+            ast_list_insert(args->d.list, variable);
             if (! accept(RPAR)) {
                 EXPECT(token_comma());
             }
@@ -896,7 +1301,10 @@ bool token_empty()
 bool parse_id(string** id)
 {
     if (PRINT) printf("\tparser: ID\n");
-    *id = new_str(d->token->value.string);
+    if (accept(IDENTIFIER)) {
+        // nazvy jsou z tabulky nazvu, porovnavaji se ukazatelem
+        *id = d->token->value.symbol;
+    }
     EXPECT(expect(IDENTIFIER));
 
     return true;
@@ -1033,3 +1441,15 @@ bool token_equals()
     if (PRINT) printf("\tparser: equals\n");
     return expect(EQUALS);
 }
+
+// uvolni pomocne buffery parseru tohoto vlakna (konec vlakna v --parallel)
+void parser_release()
+{
+    for (int i = 0; i < TOKEN_RING_SIZE; i++) {
+        free_token(&token_ring[i]);
+        token_ring[i].type = END_OF_FILE;
+    }
+    free(expr_entries);
+    expr_entries = NULL;
+    expr_top = expr_capacity = 0;
+}
@@ -1,11 +1,20 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdbool.h>
 #include "string.h"
 
 struct data* parser_run();
 void parser_prepare(struct data*);
+void parser_release(); // buffery parseru vlakna, strom zustava
+void parser_set_token_source(struct lexeme (*source)(void)); // vychozi je read_lexeme
+void parser_use_pratt(bool enable); // vyrazy Prattovym parserem, vychozi je precedencni tabulka
+void parser_use_lazy(bool enable); // tela funkci jako AST_LAZY_BODY, viz parser_parse_body
+void parser_use_stream(bool enable); // jako lazy, ale tela se pri parsovani zkontroluji
+bool parser_parse_body(struct ast_node* body); // doparsuje AST_LAZY_BODY na AST_BODY
 
 void get_token();
+struct lexeme* peek_token(int k);
+bool parse_expression(struct ast_node* node); // vysledek v node->left, prazdny vyraz NULL
 
 #endif
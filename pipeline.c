@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "pipeline.h"
+#include "scanner.h"
+#include "errors.h"
+#include "input.h"
+
+#define QUEUE_SIZE 4096 // mocnina dvojky
+#define QUEUE_MASK (QUEUE_SIZE - 1)
+
+static struct lexeme queue[QUEUE_SIZE];
+// pocitadla jen rostou, obsazeno je tail - head; kazde zapisuje jen jedna strana
+static unsigned long queue_head = 0; // konzument (parser)
+static unsigned long queue_tail = 0; // producent (lexer)
+static int queue_stop = 0; // parser skoncil, lexer uz nema cekat na misto
+
+static pthread_t lexer_thread;
+static int running = 0;
+static struct error_trap lexer_error;
+
+// posledni znama pozice druhe strany, atomicky se cte jen kdyz fronta
+// vypada plna/prazdna
+static unsigned long cached_head = 0; // vidi lexer
+static unsigned long cached_tail = 0; // vidi parser
+static struct lexeme end_token; // po konci souboru se vraci porad dokola
+static int finished = 0;
+
+// vstup je ve vlaknech zvlast, lexer prevezme pozici z pipeline_start
+static const unsigned char *source_start, *source_pos, *source_end;
+
+// vlozeni tokenu, vraci 0 pokud parser frontu zavrel
+static int queue_push(const struct lexeme *token) {
+	unsigned long tail = queue_tail;
+
+	while (tail - cached_head == QUEUE_SIZE) {
+		cached_head = __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE);
+		if (tail - cached_head < QUEUE_SIZE)
+			break;
+		if (__atomic_load_n(&queue_stop, __ATOMIC_RELAXED))
+			return 0;
+		sched_yield();
+	}
+
+	queue[tail & QUEUE_MASK] = *token;
+	__atomic_store_n(&queue_tail, tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static void *lexer_main(void *arg) {
+	struct lexeme token;
+	(void)arg;
+
+	input_start = source_start;
+	input_pos = source_pos;
+	input_end = source_end;
+	set_error_trap(&lexer_error);
+	if (setjmp(lexer_error.jump) == 0) {
+		do {
+			if (__atomic_load_n(&queue_stop, __ATOMIC_RELAXED))
+				return NULL;
+			token = read_lexeme();
+			if (!queue_push(&token))
+				return NULL;
+		} while (token.type != END_OF_FILE);
+	} else {
+		// lexer nikdy nevraci NO_TYPE, slouzi jako znacka chyby
+		memset(&token, 0, sizeof(token));
+		token.type = NO_TYPE;
+		queue_push(&token);
+	}
+
+	return NULL;
+}
+
+void pipeline_start(void) {
+	source_start = input_start;
+	source_pos = input_pos;
+	source_end = input_end;
+	if (pthread_create(&lexer_thread, NULL, lexer_main, NULL) != 0)
+		throw_error(CODE_ERROR_INTERNAL, "cannot start lexer thread");
+	running = 1;
+}
+
+struct lexeme pipeline_read_lexeme(void) {
+	unsigned long head = queue_head;
+	struct lexeme token;
+
+	if (finished)
+		return end_token;
+
+	while (head == cached_tail) {
+		cached_tail = __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE);
+		if (head != cached_tail)
+			break;
+		sched_yield();
+	}
+
+	token = queue[head & QUEUE_MASK];
+	__atomic_store_n(&queue_head, head + 1, __ATOMIC_RELEASE);
+
+	if (token.type == NO_TYPE)
+		rethrow_error(&lexer_error);
+	if (token.type == END_OF_FILE) {
+		end_token = token;
+		finished = 1;
+	}
+
+	return token;
+}
+
+void pipeline_stop(void) {
+	if (!running)
+		return;
+
+	__atomic_store_n(&queue_stop, 1, __ATOMIC_RELAXED);
+	pthread_join(lexer_thread, NULL);
+	running = 0;
+}
@@ -0,0 +1,14 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "common.h"
+
+// Lexer ve vlastnim vlakne (--pipeline). Tokeny jdou pres frontu s jednim
+// producentem (lexer) a jednim konzumentem (parser) bez zamku. Chyba lexeru
+// se vyhodi az ve chvili, kdy parser dojde k tokenu, kde nastala - stejne
+// jako pri lexovani v jednom vlakne.
+void pipeline_start(void);
+struct lexeme pipeline_read_lexeme(void); // nahrada read_lexeme pro parser
+void pipeline_stop(void);
+
+#endif
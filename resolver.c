@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <string.h>
+#include "resolver.h"
+#include "flat.h"
+#include "gc.h"
+#include "errors.h"
+
+#define RESOLVE_INITIAL 64
+
+// viditelne deklarace od zacatku funkce, vnorene bloky jsou na konci
+struct binding {
+	string* name;
+	int32_t slot;
+	int shadowed; // predchozi viditelna deklarace stejneho jmena, -1 zadna
+};
+
+static struct binding* bindings = NULL;
+static int binding_count = 0;
+static int binding_capacity = 0;
+static int scope_base = 0; // prvni deklarace aktualniho bloku
+static int32_t slot_count = 0;
+
+// jmeno -> posledni viditelna deklarace; jmena jsou internovana, klicem je
+// ukazatel (otevrene adresovani, polozky se nemazou, jen head klesne na -1)
+static string** names = NULL;
+static int* heads = NULL;
+static unsigned int names_size = 0;
+static unsigned int names_count = 0;
+
+// nazev -> AST_FUNCTION, stejne otevrene adresovani
+static string** function_names = NULL;
+static struct ast_node** function_nodes = NULL;
+static unsigned int functions_size = 0;
+static unsigned int functions_count = 0;
+
+// zasobnik pro pruchod vyrazem (leve retezce jsou hluboke, rekurze ne)
+static struct ast_node** pending = NULL;
+static int pending_capacity = 0;
+
+static void* resolve_grow(void* array, int* capacity, size_t item) {
+	*capacity = (*capacity) ? *capacity * 2 : RESOLVE_INITIAL;
+	if (!(array = gc_realloc(array, (int)(*capacity * item)))) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate name resolution");
+	}
+	return array;
+}
+
+// pozice jmena v tabulce keys velikosti size (mocnina dvojky), nebo volne misto
+static unsigned int probe(string** keys, unsigned int size, string* name) {
+	unsigned int mask = size - 1;
+	unsigned int i = (unsigned int)(((uintptr_t)name >> 4) * 2654435761u) & mask;
+
+	while (keys[i] != NULL && keys[i] != name) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+static unsigned int name_probe(string* name) {
+	return probe(names, names_size, name);
+}
+
+static void names_grow() {
+	string** old_names = names;
+	int* old_heads = heads;
+	unsigned int old_size = names_size;
+
+	names_size = (names_size) ? names_size * 2 : RESOLVE_INITIAL;
+	names = calloc(names_size, sizeof(string*));
+	heads = malloc(names_size * sizeof(int));
+	if (!names || !heads) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate name resolution");
+	}
+
+	for (unsigned int i = 0; i < old_size; i++) {
+		if (old_names[i]) {
+			unsigned int j = name_probe(old_names[i]);
+			names[j] = old_names[i];
+			heads[j] = old_heads[i];
+		}
+	}
+	free(old_names);
+	free(old_heads);
+}
+
+// polozka jmena v tabulce, nove jmeno se prida bez deklarace
+static unsigned int name_entry(string* name) {
+	if (2 * (names_count + 1) > names_size) {
+		names_grow();
+	}
+
+	unsigned int i = name_probe(name);
+	if (names[i] == NULL) {
+		names[i] = name;
+		heads[i] = -1;
+		names_count++;
+	}
+	return i;
+}
+
+// nova deklarace jmena v aktualnim bloku, vraci jeji slot
+static int32_t bind(string* name) {
+	unsigned int entry = name_entry(name);
+
+	if (binding_count == binding_capacity) {
+		bindings = resolve_grow(bindings, &binding_capacity, sizeof(struct binding));
+	}
+	bindings[binding_count].name = name;
+	bindings[binding_count].slot = slot_count;
+	bindings[binding_count].shadowed = heads[entry];
+	heads[entry] = binding_count++;
+
+	return slot_count++;
+}
+
+static void declare(struct ast_node* var) {
+	unsigned int entry = name_entry(var->d.string_data);
+
+	// stejne jako is_creatable: vadi jen deklarace ve stejnem bloku
+	var->index = (heads[entry] >= scope_base) ? RESOLVE_REDEFINED : bind(var->d.string_data);
+}
+
+static void reference(struct ast_node* var) {
+	unsigned int entry = name_entry(var->d.string_data); // muze zvetsit tabulku
+	int head = heads[entry];
+	var->index = (head >= 0) ? bindings[head].slot : RESOLVE_UNDEFINED;
+}
+
+static void functions_grow() {
+	string** old_names = function_names;
+	struct ast_node** old_nodes = function_nodes;
+	unsigned int old_size = functions_size;
+
+	functions_size = (functions_size) ? functions_size * 2 : RESOLVE_INITIAL;
+	function_names = calloc(functions_size, sizeof(string*));
+	function_nodes = malloc(functions_size * sizeof(struct ast_node*));
+	if (!function_names || !function_nodes) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate function table");
+	}
+
+	for (unsigned int i = 0; i < old_size; i++) {
+		if (old_names[i]) {
+			unsigned int j = probe(function_names, functions_size, old_names[i]);
+			function_names[j] = old_names[i];
+			function_nodes[j] = old_nodes[i];
+		}
+	}
+	free(old_names);
+	free(old_nodes);
+}
+
+bool resolve_add_function(struct ast_node* func) {
+	if (2 * (functions_count + 1) > functions_size) {
+		functions_grow();
+	}
+
+	unsigned int i = probe(function_names, functions_size, func->d.string_data);
+	if (function_names[i] != NULL) {
+		return false;
+	}
+	function_names[i] = func->d.string_data;
+	function_nodes[i] = func;
+	functions_count++;
+
+	return true;
+}
+
+struct ast_node* resolve_find_function(string* name) {
+	if (functions_size == 0) {
+		return NULL;
+	}
+
+	unsigned int i = probe(function_names, functions_size, name);
+	return (function_names[i] != NULL) ? function_nodes[i] : NULL;
+}
+
+// cil volani do call->right
+static void bind_call(struct ast_node* call) {
+	call->right = resolve_find_function(call->d.string_data);
+	if (call->right == NULL) {
+		throw_error(CODE_ERROR_SEMANTIC, "[Interpret] Calling function that was not defined");
+	}
+	// vestavena funkce (bez tela) chce presne svoje parametry
+	if (call->right->right == NULL
+		&& call->left->d.list->count != call->right->left->d.list->count) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Wrong number of arguments in builtin call");
+	}
+}
+
+static int scope_open() {
+	int outer = scope_base;
+	scope_base = binding_count;
+	return outer;
+}
+
+static void scope_close(int outer) {
+	while (binding_count > scope_base) {
+		struct binding* b = &bindings[--binding_count];
+		heads[name_probe(b->name)] = b->shadowed;
+	}
+	scope_base = outer;
+}
+
+static int push_pending(int top, struct ast_node* node) {
+	if (top == pending_capacity) {
+		pending = resolve_grow(pending, &pending_capacity, sizeof(struct ast_node*));
+	}
+	pending[top] = node;
+	return top + 1;
+}
+
+static void resolve_expression(struct ast_node* expr) {
+	int top = 0;
+
+	if (expr != NULL) {
+		top = push_pending(top, expr);
+	}
+
+	while (top > 0) {
+		struct ast_node* node = pending[--top];
+
+		switch (node->type) {
+			case AST_VAR:
+				reference(node);
+				break;
+			case AST_LITERAL:
+				break;
+			case AST_CALL: {
+				struct ast_list* args = node->left->d.list;
+				bind_call(node);
+				for (int i = 0; i < args->count; i++) {
+					top = push_pending(top, args->elems[i]);
+				}
+				break;
+			}
+			default:
+				// listy nemaji left/right
+				if (!node->leaf && node->left) {
+					top = push_pending(top, node->left);
+				}
+				if (!node->leaf && node->right) {
+					top = push_pending(top, node->right);
+				}
+				break;
+		}
+	}
+}
+
+static void resolve_list(struct ast_list* list);
+
+static void resolve_block(struct ast_list* list) {
+	int outer = scope_open();
+	resolve_list(list);
+	scope_close(outer);
+}
+
+// poradi odpovida interpretu: prava strana prirazeni se vyhodnoti pred deklaraci
+static void resolve_statement(struct ast_node* node) {
+	switch (node->type) {
+		case AST_ASSIGN:
+			resolve_expression(node->right);
+			if (node->left->type == AST_VAR_CREATION) {
+				declare(node->left->right);
+			} else {
+				reference(node->left);
+			}
+			break;
+		case AST_VAR_CREATION:
+			declare(node->right);
+			break;
+		case AST_EXPRESSION:
+		case AST_RETURN:
+		case AST_CALL:
+			resolve_expression(node->type == AST_RETURN ? node->left : node);
+			break;
+		case AST_IF:
+			resolve_expression(node->d.condition);
+			resolve_block(node->left->d.list);
+			resolve_block(node->right->d.list);
+			break;
+		case AST_FOR: {
+			// podminka a posledni pole vidi promenne z hlavicky, ne z tela
+			int outer = scope_open();
+			resolve_statement(node->d.list->elems[0]);
+			resolve_expression(node->d.list->elems[1]);
+			resolve_statement(node->d.list->elems[2]);
+			resolve_block(node->left->d.list);
+			scope_close(outer);
+			break;
+		}
+		case AST_BLOCK:
+			resolve_block(node->d.list);
+			break;
+		case AST_COUT:
+			for (int i = 0; i < node->d.list->count; i++) {
+				resolve_expression(node->d.list->elems[i]);
+			}
+			break;
+		case AST_CIN:
+			for (int i = 0; i < node->d.list->count; i++) {
+				reference(node->d.list->elems[i]);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void resolve_list(struct ast_list* list) {
+	for (int i = 0; i < list->count; i++) {
+		resolve_statement(list->elems[i]);
+	}
+}
+
+void resolve_function(struct ast_node* func) {
+	if (func->index != FLAT_NONE) {
+		return;
+	}
+
+	binding_count = scope_base = 0;
+	slot_count = 0;
+
+	// parametry jsou sloty 0..n-1 a telo je ve stejnem bloku jako ony
+	struct ast_list* params = func->left->d.list;
+	for (int i = 0; i < params->count; i++) {
+		params->elems[i]->index = bind(params->elems[i]->d.string_data);
+	}
+	resolve_list(func->right->d.list);
+	scope_close(0);
+
+	func->index = slot_count;
+}
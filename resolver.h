@@ -0,0 +1,36 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ast.h"
+
+// Rozliseni jmen promennych pred interpretaci. Kazda deklarace (i parametr)
+// dostane vlastni slot v ramci funkce a kazdy vyskyt promenne (AST_VAR)
+// si v index zapamatuje slot deklarace, ktera je v tom miste videt. Za
+// behu se pak promenna hleda primo v poli ramce volani, bez retezcu.
+// Chyby se nehlasi hned - uzel dostane znacku a interpret vyhodi stejnou
+// chybu jako drive, az kdyz na nej dojde.
+//
+// Volani funkce (AST_CALL) se pri tom navaze na cilovou AST_FUNCTION
+// v call->right, takze se za behu nic nehleda podle jmena. Volani funkce,
+// ktera neni v tabulce funkci, je semanticka chyba hned pri rozliseni.
+// Vestavene funkce jsou v tabulce jako AST_FUNCTION bez tela (right NULL)
+// a jejich volani musi mit presne tolik argumentu, kolik maji parametru.
+//
+// Po resolve_function uz index ani right uzlu nejsou volne, cache_store
+// musi byt driv.
+
+#define RESOLVE_UNDEFINED (-2) // jmeno v tom miste neni deklarovane
+#define RESOLVE_REDEFINED (-3) // deklarace jmena, ktere uz ve stejnem bloku je
+
+// tabulka funkci podle (internovaneho) jmena, vcetne vestavenych;
+// false pokud uz funkce toho jmena je
+bool resolve_add_function(struct ast_node* func);
+struct ast_node* resolve_find_function(string* name); // NULL = neni
+
+// rozlisi telo funkce (uz zparsovane), pocet slotu ramce ulozi do func->index;
+// vsechny funkce uz musi byt v tabulce; podruhe nic nedela
+void resolve_function(struct ast_node* func);
+
+#endif
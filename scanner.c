@@ -1,627 +1,470 @@
 #include "scanner.h"
 
-#define PRINT 0
+//perfektni hash klicovych slov z delky, prvniho a posledniho znaku,
+//konstanty jsou vybrane tak, aby zadna dve klicova slova nekolidovala
+#define KEYWORD_HASH(len, first, last) (((len) + 5 * (first) + (last)) & 15)
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 6
 
-const static struct {
+static const struct {
   char* id;
+  int length;
   enum lex_type type;
-} keywords_table[] = {
-  {"auto", KW_AUTO}, {"cin", KW_CIN}, {"cout", KW_COUT}, {"double", KW_DOUBLE}, {"else", KW_ELSE},
-  {"for", KW_FOR}, {"if", KW_IF}, {"int", KW_INT}, {"return", KW_RETURN}, {"string", KW_STRING},
-  {NULL, NO_TYPE}
+} keywords_table[16] = {
+  [8] = {"auto", 4, KW_AUTO}, [0] = {"cin", 3, KW_CIN}, [7] = {"cout", 4, KW_COUT}, [15] = {"double", 6, KW_DOUBLE},
+  [2] = {"else", 4, KW_ELSE}, [3] = {"for", 3, KW_FOR}, [5] = {"if", 2, KW_IF}, [4] = {"int", 3, KW_INT},
+  [14] = {"return", 6, KW_RETURN}, [12] = {"string", 6, KW_STRING}
 };
 
-unsigned char tmp_esc_val[2];
-static int input_char; //prave nacteny znak
-static enum input_type input_char_type; //prave nacteny typ znaku
+//tridy znaku pro prechodovou tabulku
+enum char_class {
+  CC_OTHER,
+  CC_SPACE, //mezera
+  CC_WHITE, //ostatni bile znaky (<= 32)
+  CC_NEWLINE,
+  CC_LETTER,
+  CC_EXP, //e E
+  CC_DIGIT,
+  CC_UNDERSCORE,
+  CC_PLUS,
+  CC_MINUS,
+  CC_STAR,
+  CC_SLASH,
+  CC_EQUALS,
+  CC_LESS,
+  CC_GREATER,
+  CC_BANG,
+  CC_LPAR,
+  CC_RPAR,
+  CC_LBR,
+  CC_RBR,
+  CC_SEMICOLON,
+  CC_COMMA,
+  CC_DOT,
+  CC_QUOTE,
+  CC_BACKSLASH,
+  CC_END,
+  CC_COUNT,
+  CC_ANY = CC_COUNT //vychozi prechod stavu v tabulce pravidel
+};
+
+//stavy automatu (v komentari puvodni oznaceni)
+enum scan_state {
+  S_START, //q0
+  S_ID, //q1
+  S_SLASH, //q3
+  S_LINE_COMMENT,
+  S_BLOCK_COMMENT,
+  S_BLOCK_STAR,
+  S_INT, //q4
+  S_EXP_START, //q5
+  S_FRACTION, //q6
+  S_EXP, //q7
+  S_FRACTION_START, //q13
+  S_EXP_SIGN, //q14
+  S_EQUALS,
+  S_LESS,
+  S_GREATER,
+  S_BANG,
+  S_STRING, //q8
+  S_ESCAPE, //q9
+  S_HEX_HIGH, //q16
+  S_HEX_LOW, //q17
+  S_COUNT
+};
+
+//co se stane s prave nactenym znakem
+enum scan_action {
+  A_ERROR, //lexikalni chyba
+  A_SKIP, //zahodit
+  A_BEGIN_STRING,
+  A_STRING, //znak retezce, kopiruje se jen pokud retezec obsahuje escape
+  A_BEGIN_ESCAPE, //zpetne lomitko, od ted se retezec dekoduje do bufferu
+  A_ESCAPE, //znak za zpetnym lomitkem
+  A_HEX, //hexadecimalni cislice v \xhh
+  A_EMIT, //znak patri k lexemu, lexem je hotovy
+  A_EMIT_BACK //znak vratit na vstup, lexem je hotovy
+};
+
+struct transition {
+  unsigned char next;
+  unsigned char action;
+  unsigned char token;
+};
+
+//pravidla, ze kterych se sestavi prechodova tabulka
+//CC_ANY nastavuje vychozi prechod, konkretni tridy ho prepisuji
+static const struct {
+  enum scan_state state;
+  enum char_class cls;
+  enum scan_state next;
+  enum scan_action action;
+  enum lex_type token;
+} rules[] = {
+  {S_START, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_START, CC_SPACE, S_START, A_SKIP, NO_TYPE},
+  {S_START, CC_WHITE, S_START, A_SKIP, NO_TYPE},
+  {S_START, CC_NEWLINE, S_START, A_SKIP, NO_TYPE},
+  {S_START, CC_LETTER, S_ID, A_SKIP, NO_TYPE},
+  {S_START, CC_EXP, S_ID, A_SKIP, NO_TYPE},
+  {S_START, CC_UNDERSCORE, S_ID, A_SKIP, NO_TYPE},
+  {S_START, CC_DIGIT, S_INT, A_SKIP, NO_TYPE},
+  {S_START, CC_END, S_START, A_EMIT, END_OF_FILE},
+  {S_START, CC_PLUS, S_START, A_EMIT, PLUS},
+  {S_START, CC_MINUS, S_START, A_EMIT, MINUS},
+  {S_START, CC_STAR, S_START, A_EMIT, MULT},
+  {S_START, CC_SLASH, S_SLASH, A_SKIP, NO_TYPE},
+  {S_START, CC_EQUALS, S_EQUALS, A_SKIP, NO_TYPE},
+  {S_START, CC_LESS, S_LESS, A_SKIP, NO_TYPE},
+  {S_START, CC_GREATER, S_GREATER, A_SKIP, NO_TYPE},
+  {S_START, CC_BANG, S_BANG, A_SKIP, NO_TYPE},
+  {S_START, CC_SEMICOLON, S_START, A_EMIT, SEMICOLON},
+  {S_START, CC_LPAR, S_START, A_EMIT, LPAR},
+  {S_START, CC_RPAR, S_START, A_EMIT, RPAR},
+  {S_START, CC_LBR, S_START, A_EMIT, LBR},
+  {S_START, CC_RBR, S_START, A_EMIT, RBR},
+  {S_START, CC_COMMA, S_START, A_EMIT, COLON},
+  {S_START, CC_QUOTE, S_STRING, A_BEGIN_STRING, NO_TYPE},
+
+  {S_ID, CC_ANY, S_START, A_EMIT_BACK, IDENTIFIER},
+  {S_ID, CC_LETTER, S_ID, A_SKIP, NO_TYPE},
+  {S_ID, CC_EXP, S_ID, A_SKIP, NO_TYPE},
+  {S_ID, CC_DIGIT, S_ID, A_SKIP, NO_TYPE},
+  {S_ID, CC_UNDERSCORE, S_ID, A_SKIP, NO_TYPE},
+
+  {S_SLASH, CC_ANY, S_START, A_EMIT_BACK, DIVIDE},
+  {S_SLASH, CC_SLASH, S_LINE_COMMENT, A_SKIP, NO_TYPE},
+  {S_SLASH, CC_STAR, S_BLOCK_COMMENT, A_SKIP, NO_TYPE},
+
+  {S_LINE_COMMENT, CC_ANY, S_LINE_COMMENT, A_SKIP, NO_TYPE},
+  {S_LINE_COMMENT, CC_NEWLINE, S_START, A_SKIP, NO_TYPE},
+  {S_LINE_COMMENT, CC_END, S_START, A_EMIT, END_OF_FILE},
+
+  {S_BLOCK_COMMENT, CC_ANY, S_BLOCK_COMMENT, A_SKIP, NO_TYPE},
+  {S_BLOCK_COMMENT, CC_STAR, S_BLOCK_STAR, A_SKIP, NO_TYPE},
+  {S_BLOCK_COMMENT, CC_END, S_START, A_ERROR, NO_TYPE},
+
+  {S_BLOCK_STAR, CC_ANY, S_BLOCK_COMMENT, A_SKIP, NO_TYPE},
+  {S_BLOCK_STAR, CC_STAR, S_BLOCK_STAR, A_SKIP, NO_TYPE},
+  {S_BLOCK_STAR, CC_SLASH, S_START, A_SKIP, NO_TYPE},
+  {S_BLOCK_STAR, CC_END, S_START, A_ERROR, NO_TYPE},
+
+  {S_INT, CC_ANY, S_START, A_EMIT_BACK, INTEGER},
+  {S_INT, CC_DIGIT, S_INT, A_SKIP, NO_TYPE},
+  {S_INT, CC_EXP, S_EXP_START, A_SKIP, NO_TYPE},
+  {S_INT, CC_DOT, S_FRACTION_START, A_SKIP, NO_TYPE},
+  {S_INT, CC_LETTER, S_START, A_ERROR, NO_TYPE},
+  {S_INT, CC_UNDERSCORE, S_START, A_ERROR, NO_TYPE},
+
+  {S_FRACTION_START, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_FRACTION_START, CC_DIGIT, S_FRACTION, A_SKIP, NO_TYPE},
 
-static char temp[CHUNK];
-//static char* safeStr = "74|75|99|111|112|121|114|105|103|104|116";
-static int temp_length;
+  {S_FRACTION, CC_ANY, S_START, A_EMIT_BACK, DOUBLE},
+  {S_FRACTION, CC_DIGIT, S_FRACTION, A_SKIP, NO_TYPE},
+  {S_FRACTION, CC_EXP, S_EXP_START, A_SKIP, NO_TYPE},
+  {S_FRACTION, CC_LETTER, S_START, A_ERROR, NO_TYPE},
+
+  {S_EXP_START, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_EXP_START, CC_DIGIT, S_EXP, A_SKIP, NO_TYPE},
+  {S_EXP_START, CC_PLUS, S_EXP_SIGN, A_SKIP, NO_TYPE},
+  {S_EXP_START, CC_MINUS, S_EXP_SIGN, A_SKIP, NO_TYPE},
+
+  {S_EXP_SIGN, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_EXP_SIGN, CC_DIGIT, S_EXP, A_SKIP, NO_TYPE},
+
+  {S_EXP, CC_ANY, S_START, A_EMIT_BACK, DOUBLE},
+  {S_EXP, CC_DIGIT, S_EXP, A_SKIP, NO_TYPE},
+
+  {S_EQUALS, CC_ANY, S_START, A_EMIT_BACK, EQUALS},
+  {S_EQUALS, CC_EQUALS, S_START, A_EMIT, EQ},
+
+  {S_LESS, CC_ANY, S_START, A_EMIT_BACK, LT},
+  {S_LESS, CC_EQUALS, S_START, A_EMIT, LTE},
+  {S_LESS, CC_LESS, S_START, A_EMIT, INSOP},
+
+  {S_GREATER, CC_ANY, S_START, A_EMIT_BACK, GT},
+  {S_GREATER, CC_EQUALS, S_START, A_EMIT, GTE},
+  {S_GREATER, CC_GREATER, S_START, A_EMIT, EXTOP},
+
+  {S_BANG, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_BANG, CC_EQUALS, S_START, A_EMIT, NEQ},
+
+  {S_STRING, CC_ANY, S_STRING, A_STRING, NO_TYPE},
+  {S_STRING, CC_WHITE, S_START, A_ERROR, NO_TYPE},
+  {S_STRING, CC_NEWLINE, S_START, A_ERROR, NO_TYPE},
+  {S_STRING, CC_END, S_START, A_ERROR, NO_TYPE},
+  {S_STRING, CC_QUOTE, S_START, A_EMIT, STRING},
+  {S_STRING, CC_BACKSLASH, S_ESCAPE, A_BEGIN_ESCAPE, NO_TYPE},
+
+  //dalsi stav za zpetnym lomitkem urcuje az akce (\x pokracuje na S_HEX_HIGH)
+  {S_ESCAPE, CC_ANY, S_STRING, A_ESCAPE, NO_TYPE},
+  {S_ESCAPE, CC_END, S_START, A_ERROR, NO_TYPE},
+
+  {S_HEX_HIGH, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_HEX_HIGH, CC_DIGIT, S_HEX_LOW, A_HEX, NO_TYPE},
+  {S_HEX_HIGH, CC_LETTER, S_HEX_LOW, A_HEX, NO_TYPE},
+  {S_HEX_HIGH, CC_EXP, S_HEX_LOW, A_HEX, NO_TYPE},
+
+  {S_HEX_LOW, CC_ANY, S_START, A_ERROR, NO_TYPE},
+  {S_HEX_LOW, CC_DIGIT, S_STRING, A_HEX, NO_TYPE},
+  {S_HEX_LOW, CC_LETTER, S_STRING, A_HEX, NO_TYPE},
+  {S_HEX_LOW, CC_EXP, S_STRING, A_HEX, NO_TYPE}
+};
+
+static unsigned char char_class[256]; //trida kazdeho znaku
+static struct transition transitions[S_COUNT][CC_COUNT]; //prechodova tabulka
+
+// stav lexeru je pro kazde vlakno zvlast, tabulky vyse jsou po scanner_init jen ke cteni
+static __thread int input_char; //prave nacteny znak
+static __thread enum char_class input_char_type; //prave nacteny typ znaku
 
 static void save(struct lexeme *, char); //trvale ulozeni retezce do lexemu
-static void save_temp(char); //docasne ulozeni stringu
 
-static int length; //delka retezce
-static int chunks; //zvetsovani bufferu
+static __thread int length; //delka dekodovaneho retezce
+static __thread int string_size; //velikost bufferu dekodovaneho retezce
+static __thread int decoding; //retezec obsahuje escape sekvence, uklada se do bufferu
 
-static char *e_strtod; //osetreni parametru pro prevod cisel double
-static unsigned char tmpx = 0;
+static __thread unsigned char tmpx = 0;
 
 
-enum lex_type check_keyword(char* candidate) {
-  int i = -1;
+void scanner_init() {
+  int c;
+  unsigned int i;
 
-  while(keywords_table[++i].id) //pruchod celou tabulkou symbolu
-    if(!strcmp((const char *)candidate, (const char *)keywords_table[i].id)) //porovnani identifikatoru a kandidatnich klicu
-      return keywords_table[i].type; //jedna se o kw
+  //tabulka trid znaku
+  for(c = 0; c < 256; c++) {
+    if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+      char_class[c] = (c == 'e' || c == 'E') ? CC_EXP : CC_LETTER;
+    else if(c >= '0' && c <= '9')
+      char_class[c] = CC_DIGIT;
+    else if(c == ' ')
+      char_class[c] = CC_SPACE;
+    else if(c == '\n')
+      char_class[c] = CC_NEWLINE;
+    else if(c < ' ')
+      char_class[c] = CC_WHITE;
+    else
+      char_class[c] = CC_OTHER;
+  }
+  char_class['_'] = CC_UNDERSCORE;
+  char_class['+'] = CC_PLUS;
+  char_class['-'] = CC_MINUS;
+  char_class['*'] = CC_STAR;
+  char_class['/'] = CC_SLASH;
+  char_class['='] = CC_EQUALS;
+  char_class['<'] = CC_LESS;
+  char_class['>'] = CC_GREATER;
+  char_class['!'] = CC_BANG;
+  char_class['('] = CC_LPAR;
+  char_class[')'] = CC_RPAR;
+  char_class['{'] = CC_LBR;
+  char_class['}'] = CC_RBR;
+  char_class[';'] = CC_SEMICOLON;
+  char_class[','] = CC_COMMA;
+  char_class['.'] = CC_DOT;
+  char_class['"'] = CC_QUOTE;
+  char_class['\\'] = CC_BACKSLASH;
+
+  //prechodova tabulka z pravidel
+  for(i = 0; i < sizeof(rules) / sizeof(rules[0]); i++) {
+    struct transition t = { rules[i].next, rules[i].action, rules[i].token };
+    if(rules[i].cls == CC_ANY) {
+      for(c = 0; c < CC_COUNT; c++)
+        transitions[rules[i].state][c] = t;
+    } else {
+      transitions[rules[i].state][rules[i].cls] = t;
+    }
+  }
+}
+
+enum lex_type check_keyword(const char* candidate, int len) {
+  int i;
+
+  if(len < KEYWORD_MIN_LENGTH || len > KEYWORD_MAX_LENGTH)
+    return IDENTIFIER;
+
+  //jediny kandidat v tabulce, prazdne pozice maji nulovou delku
+  i = KEYWORD_HASH(len, (unsigned char)candidate[0], (unsigned char)candidate[len - 1]);
+  if(keywords_table[i].length == len && !memcmp(candidate, keywords_table[i].id, len))
+    return keywords_table[i].type; //jedna se o kw
 
   return IDENTIFIER; //jedna se o identif.
 }
 
 void read_input() {
   input_char = get_char(); //nacteni znaku ze vstupu
-  //prirazeni typu znaku
-  if(tolower(input_char) >= 'a' && tolower(input_char) <= 'z')
-    input_char_type = LETTER;
-  else if(input_char >= '0' && input_char <= '9')
-    input_char_type = DIGIT;
-  else if(input_char == EOF)
-    input_char_type = END;
-  else if(input_char <= 32)
-    input_char_type = WHITE_SPACE;
-  else if(input_char == '_')
-    input_char_type = UNDERSCORE;
-  else
-    input_char_type = OTHERS;
+  input_char_type = (input_char == EOF) ? CC_END : char_class[input_char]; //prirazeni typu znaku
 }
 
 void return_input() {
 	return_char(input_char); //vraceni znaku na vstup
 }
 
-//hlavni funkce
-struct lexeme read_lexeme(void) {
-	struct lexeme tmpData;
-	tmpData.type = NO_TYPE;
+//hodnota hexadecimalni cislice, -1 pokud to cislice neni
+static int hex_value(int c) {
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
 
-	read_input();
-
-q0: //default state
-	if(PRINT) printf("q0 default\n");
-	switch(input_char_type) {
-		case UNDERSCORE:
-		case LETTER:
-			temp_length = 0;
-			save_temp(input_char);
-			read_input();
-			goto q1; //identifier
-		case DIGIT:
-			tmpData.type = INTEGER;
-			temp_length = 0;
-			save_temp(input_char);
-			read_input();
-			goto q4; //integer or double
-			break;
-		case WHITE_SPACE:
-			read_input();
-			goto q0; //default state
-		/*
-		case UNDERSCORE:
-			temp_length = 0;
-			save_temp(input_char);
-			read_input();
-			goto q1; //underscored identifier
-		*/
-		case END:
-			tmpData.type = END_OF_FILE;
-			return tmpData;
-		case OTHERS:
-			switch(input_char) {
-				case '+':
-					tmpData.type = PLUS;
-					return tmpData;
-				case '-':
-					tmpData.type = MINUS;
-					return tmpData;
-				case '*':
-					tmpData.type = MULT;
-					return tmpData;
-				case '/':
-					read_input();
-					goto q3; //comments or divide
-				case '=':
-					read_input();
-					if(input_char == '=') {
-						tmpData.type = EQ;
-						return tmpData;
-					}
-					return_input();
-					tmpData.type = EQUALS;
-					return tmpData;
-				case '<':
-					read_input();
-					if(input_char == '=') {
-						tmpData.type = LTE;
-						return tmpData;
-					} else if(input_char == '<') {
-						tmpData.type = INSOP;
-						return tmpData;
-					}
-					return_input();
-					tmpData.type = LT;
-					return tmpData;
-				case '>':
-					read_input();
-					if(input_char == '=') {
-						tmpData.type = GTE;
-						return tmpData;
-					} else if(input_char == '>') {
-						tmpData.type = EXTOP;
-						return tmpData;
-					}
-					return_input();
-					tmpData.type = GT;
-					return tmpData;
-				case '!':
-					read_input();
-					if(input_char == '=') {
-						tmpData.type = NEQ;
-						return tmpData;
-					}
-					throw_error(CODE_ERROR_LEX, "invalid input");
-					break;
-				case ';':
-					tmpData.type = SEMICOLON;
-					return tmpData;
-				case '(':
-					tmpData.type = LPAR;
-					return tmpData;
-				case ')':
-					tmpData.type = RPAR;
-					return tmpData;
-				case '{':
-					tmpData.type = LBR;
-					return tmpData;
-				case '}':
-					tmpData.type = RBR;
-					return tmpData;
-				case ',':
-					tmpData.type = COLON;
-					return tmpData;
-				case '"':
-					tmpData.type = STRING;
-					temp_length = 0;
-					chunks = 0;
-					length = 0;
-					read_input();
-					goto q8; //string
-				default:
-					throw_error(CODE_ERROR_LEX, "invalid input");
-					break;
-			}
-			break;
-		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;
-	}
+//dokonceni lexemu daneho typu - prevod hodnoty ze zdrojoveho textu
+static void finish_lexeme(struct lexeme *tmpData, enum lex_type type) {
+	tmpData->type = type;
 
-q1: //identifier OK
-	if(PRINT) printf("q1 identifier\n");
-	switch(input_char_type) {
-		case LETTER:
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q1; //identifier
-		case UNDERSCORE:
-			save_temp(input_char);
-			read_input();
-			goto q1; //underscored identifier
-		default:
-			return_input();
-			save_temp(0);
-			if((tmpData.type = check_keyword(temp)) == IDENTIFIER) {
-				if((tmpData.value.string = (char *)malloc(temp_length)) == NULL)
-					throw_error(CODE_ERROR_INTERNAL, "malloc error");
-				memcpy((void *)tmpData.value.string, (void *)temp, temp_length);
-			}
-			return tmpData;
-	}
-/*
-q2: //underscored identifier OK
-	if(PRINT) printf("q2 underscored identifier\n");
-	switch(input_char_type) {
-		case LETTER:
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q1; //identifier
-		case UNDERSCORE:
-			save_temp(input_char);
-			read_input();
-			goto q2; //underscored identifier
-		default:
-			return_input();
-			return tmpData;
-	}
-*/
-q3: //comments or divide OK
-	if(PRINT) printf("q3 comments or divide\n");
-	switch(input_char_type) {
-		case LETTER:
-		case DIGIT:
-		case WHITE_SPACE:
-			return_input();
-			tmpData.type = DIVIDE;
-			return tmpData;
-		default:
-			switch(input_char) {
-				case '/':
-					//q11
-					do {
-						read_input();
-					} while(input_char != '\n' && input_char_type != END);
-					if(input_char_type == END) {
-						tmpData.type = END_OF_FILE;
-						return tmpData;
-					}
-					read_input();
-					goto q0; //default state
-				case '*':
-					//q12
-					do {
-						do {
-							read_input();
-						} while(input_char != '*' && input_char_type != END);
-						if(input_char_type == END) {
-							throw_error(CODE_ERROR_LEX, "invalid input");
-							break;
-						}
-						read_input();
-						if(input_char == '/') {
-							read_input();
-							goto q0; //default state
-						} else if(input_char == '*') {
-							return_input();
-						} else if(input_char_type == END) {
-							throw_error(CODE_ERROR_LEX, "invalid input");
-							break;
-						}
-					} while(1);
-				default:
-					return_input();
-					tmpData.type = DIVIDE;
-					return tmpData;
-			}
+	switch(type) {
+		case IDENTIFIER:
+			//identifikator se nekopiruje, lexem ukazuje do zdrojoveho textu
+			tmpData->length = (int)(input_pos - input_start) - tmpData->offset;
+			tmpData->type = check_keyword((const char *)input_start + tmpData->offset, tmpData->length);
+			if(tmpData->type == IDENTIFIER) //stejne nazvy dostanou stejny ukazatel
+				tmpData->value.symbol = intern((const char *)input_start + tmpData->offset, tmpData->length);
 			break;
-	}
-
-q4: //integer or double OK
-	if(PRINT) printf("q4 integer or double\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q4; //integer or double
-		/*
-		case WHITE_SPACE:
-			save_temp(0);
-			tmpData.value.integer = atoi((const char *)temp);
-			return tmpData;
-		*/
-		case LETTER:
-			if(input_char == 'e' || input_char == 'E') {
-				save_temp(input_char);
-				read_input();
-				tmpData.type = DOUBLE;
-				goto q5; //double e
+		case INTEGER:
+		case DOUBLE:
+			tmpData->length = (int)(input_pos - input_start) - tmpData->offset;
+			if(tmpData->length >= CHUNK)
+				throw_error(CODE_ERROR_LEX, "number too long");
+			if(type == INTEGER)
+				tmpData->value.integer = parse_int((const char *)input_start + tmpData->offset, tmpData->length);
+			else
+				tmpData->value.real = parse_double((const char *)input_start + tmpData->offset, tmpData->length);
+			break;
+		case STRING:
+			if(decoding) {
+				save(tmpData, 0); //UZAVRENI RETEZCE NULOVYM ZNAKEM
+				tmpData->length = length - 1;
 			} else {
-				throw_error(CODE_ERROR_LEX, "invalid input");
-				break;
+				//bez escape sekvenci staci odkaz do zdroje (bez koncove uvozovky)
+				tmpData->length = (int)(input_pos - input_start) - 1 - tmpData->offset;
 			}
-		case END:
-			/*
-			throw_error(CODE_ERROR_LEX, "invalid input");
 			break;
-			*/
-			return_input();
-			save_temp(0);
-			tmpData.value.integer = atoi((const char *)temp);
-			return tmpData;			
-		case UNDERSCORE:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;				
-		case OTHERS:			
-			if(input_char == '.') {
-				save_temp(input_char);
-				read_input();
-				tmpData.type = DOUBLE;
-				goto q13; //double
-			}
-			return_input();
-			save_temp(0);
-			tmpData.value.integer = atoi((const char *)temp);
-			return tmpData;		
-		default:
-			return_input();
-			save_temp(0);
-			tmpData.value.integer = atoi((const char *)temp);
-			return tmpData;
-	}
-
-q5: //double e OK
-	if(PRINT) printf("q5 double e\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q7; //double e
-		case OTHERS:
-			if(input_char == '+' || input_char == '-') {  
-				save_temp(input_char);
-				read_input();
-				goto q14; //double e +-
-			}/* else {
-				return_input();
-				save_temp(0);
-				tmpData.value.real = strtod((const char *)temp, &e_strtod);
-				return tmpData;
-			}*/	
 		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
 			break;
 	}
+}
 
-q13: //potential double
-	if(PRINT) printf("q13 potential double\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q6; //double
-		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;				
-	} 
-	
-q14: //potential double e +-
-	if(PRINT) printf("q14 potential double e +-\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q7; //double e +-
-		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;				
-	} 	
-
-q6: //double OK
-	if(PRINT) printf("q6 double\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q6; //double
-		case LETTER:
-			if(input_char == 'e' || input_char == 'E') {
-				save_temp(input_char);
-				read_input();
-				goto q5; //double e
-			} else {
-				throw_error(CODE_ERROR_LEX, "invalid input");
-				break;
-			}
-		/*
-		case WHITE_SPACE:
-			save_temp(0);
-			tmpData.value.real = strtod((const char *)temp, &e_strtod);
-			return tmpData;
-		case END:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;
-		*/ 
-		default:
-			return_input();
-			save_temp(0);
-			tmpData.value.real = strtod((const char *)temp, &e_strtod);
-			return tmpData;
-	}
+//hlavni funkce - jeden pruchod tabulkou na kazdy nacteny znak
+struct lexeme read_lexeme(void) {
+	struct lexeme tmpData;
+	enum scan_state state = S_START;
+	const struct transition *t;
+	int hex;
 
-q7: //double e +- OK
-	if(PRINT) printf("q7 double e +-\n");
-	switch(input_char_type) {
-		case DIGIT:
-			save_temp(input_char);
-			read_input();
-			goto q7; //double e +-
-		/*
-		case WHITE_SPACE:
-			save_temp(0);
-			tmpData.value.real = strtod((const char *)temp, &e_strtod);
-			return tmpData;
-		case END:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;
-		*/
-		default:
-			return_input();
-			save_temp(0);
-			tmpData.value.real = strtod((const char *)temp, &e_strtod);
-			return tmpData;
-	}
+	tmpData.type = NO_TYPE;
 
-q8: //string OK
-	if(PRINT) printf("q8 string\n");
-	switch(input_char_type) {
-		case OTHERS:	
-		 		if(input_char == '\\') {
-				//save(&tmpData, input_char);
-				read_input();
-				goto q9;	//escaped string
-			} else if(input_char == '"') {
-				//q10
-				save(&tmpData, 0);  //UZAVRENI RETEZCE NULOVYM ZNAKEM
-				return tmpData;
-			}
-			save(&tmpData, input_char);
-			read_input();
-			goto q8; //string
-		case WHITE_SPACE:	
-				if(input_char == 32) {
-				save(&tmpData, input_char);
-				read_input();
-				goto q8; //string	
-			}
-			printf("%d\n",input_char);	
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;
-		case END:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;
-		default:	
-			save(&tmpData, input_char);
-			read_input();
-			goto q8;  //string
-	}
+	while(1) {
+		//znaky, ktere by tabulka jen preskocila, se preskoci najednou
+		if(state == S_START) {
+			skip_whitespace();
+			tmpData.offset = (int)(input_pos - input_start); //lexem zacina tady
+		}
+		else if(state == S_LINE_COMMENT)
+			skip_line();
+		else if(state == S_BLOCK_COMMENT)
+			skip_block_comment();
 
-q9: //escaped string OK
-	if(PRINT) printf("q9 escaped string\n");
-	switch(input_char_type) {
-		case END:
-		if(PRINT) printf("vypis 1\n");
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;			
-		default:
-		if(PRINT) printf("vypis 2\n");
-		
-		//  n -> \n   t -> \t   /* LOMITKA DOPLNENA */
-		
-			if(input_char == 'n' || input_char == 't' || input_char == '\\' || input_char == '"') 
-			{
-												if(PRINT) printf("vypis 3\n");
-			//	save(&tmpData, '\\');   NENMA TU BYT
- 				if(input_char == 'n')
- 				save(&tmpData, '\n');	
- 				else if (input_char == 't')
- 				save(&tmpData, '\t');
- 				else
-				save(&tmpData, input_char);
-												if(PRINT) printf("vypis 5\n");
-				read_input();
-												if(PRINT) printf("vypis 6\n");
-				goto q8;  //string
-												if(PRINT) printf("vypis 7\n");
-			} else if(input_char == 'x') 
-												if(PRINT) printf("vypis 8\n");
-			{
-				read_input();
-												if(PRINT) printf("vypis 9\n");
-				goto q16;
-			}
-			throw_error(CODE_ERROR_LEX, "invalid input");
-												if(PRINT) printf("\n");
-			break;			
-	}
-	
-	
-	
-q16: //escaped string x
-
-tmpx = 0;
-	switch(input_char_type) {
-		case LETTER:
-									if(PRINT) printf("vypis 10\n");
-			if(input_char >= 'A' && input_char <= 'F') {
-								tmpx += (input_char - 'A'+10)*16;
-				
-												break;
-									if(PRINT) printf("vypis 11\n");
-								
-			} else if(input_char >= 'a' && input_char <= 'f') {
-								tmpx += (input_char - 'a'+10)*16;
-				
-									if(PRINT) printf("vypis 12\n");	
-								break;						
-					
-			}
-			throw_error(CODE_ERROR_LEX, "invalid input");
-	
-						
-		case DIGIT:
-			tmpx += (input_char - '0')*16;
-			//ulozit do tmp promenne ....prevod na cislo dokoncit z hexadec. na cislo
-			//neznamekovy char, nasobeni 16
-			// tmp_esc_val[0] = '2';  DELETE
- 			//printf("** %i\n", tmp_esc_val);
-			//printf("** %c\n", tmp_esc_val);			
-			//tmp_esc_val = input_char * 16;
-					if(PRINT) printf("vypis 14\n");
-			
-			break;
-		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;		
-	}
-	read_input();
-	goto q17;
-	
-q17: //escaped string xH
-	switch(input_char_type) {
-		case LETTER:
-		if(input_char >= 'A' && input_char <= 'F') {
-				tmpx += (input_char - 'A'+10);
+		read_input();
+		t = &transitions[state][input_char_type];
+
+		switch(t->action) {
+			case A_SKIP:
 				break;
-									
-			} else if(input_char >= 'a' && input_char <= 'f') {
-				tmpx += (input_char - 'a'+10);
-				break;							
-			}
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			
-		case DIGIT:
-			tmpx += (input_char - '0');
-			break;
-			//tmp_esc_val[1] = '1';
-			//const char *frmtChar = hexToInt(tmp_esc_val);
-			//unsigned char *resChar;
-			//sscanf(&frmtChar, "%c", &resChar);
-		
-		default:
-			throw_error(CODE_ERROR_LEX, "invalid input");
-			break;		
-	}	
-	save(&tmpData,tmpx);			
-	read_input();
-	goto q8;
-	}
+			case A_BEGIN_STRING:
+				tmpData.offset = (int)(input_pos - input_start);
+				tmpData.value.string = NULL;
+				string_size = 0;
+				length = 0;
+				decoding = 0;
+				break;
+			case A_STRING:
+				if(decoding)
+					save(&tmpData, input_char);
+				break;
+			case A_BEGIN_ESCAPE:
+				if(!decoding) {
+					//prvni escape - zkopiruje se dosud nactena cast retezce
+					const unsigned char *c = input_start + tmpData.offset;
+					while(c < input_pos - 1)
+						save(&tmpData, *c++);
+					decoding = 1;
+				}
+				break;
+			case A_ESCAPE:
+				//  n -> \n   t -> \t
+				if(input_char == 'n')
+					save(&tmpData, '\n');
+				else if(input_char == 't')
+					save(&tmpData, '\t');
+				else if(input_char == '\\' || input_char == '"')
+					save(&tmpData, input_char);
+				else if(input_char == 'x') {
+					tmpx = 0;
+					state = S_HEX_HIGH;
+					continue;
+				} else
+					throw_error(CODE_ERROR_LEX, "invalid input");
+				break;
+			case A_HEX:
+				if((hex = hex_value(input_char)) < 0)
+					throw_error(CODE_ERROR_LEX, "invalid input");
+				tmpx = tmpx * 16 + hex;
+				if(state == S_HEX_LOW)
+					save(&tmpData, tmpx);
+				break;
+			case A_EMIT_BACK:
+				return_input();
+				finish_lexeme(&tmpData, t->token);
+				return tmpData;
+			case A_EMIT:
+				finish_lexeme(&tmpData, t->token);
+				return tmpData;
+			default:
+				throw_error(CODE_ERROR_LEX, "invalid input");
+				break;
+		}
 
-unsigned char hexToInt(unsigned char *tmp)
-{
-	unsigned char hp1, hp2;
-	unsigned char h1 = tmp[0];
-	if(h1 >= '0' && h1 <= '9') {
-		hp1 = h1 - '0';
-	} else if(h1 >= 'a' && h1 <= 'f') {
-		hp1 = h1 - 'a' + 10;
-	} else if(h1 >= 'A' && h1 <= 'F') {
-		hp1 = h1 - 'A' + 10;
+		state = t->next;
 	}
-	unsigned char h2 = tmp[1];
-	if(h2 >= '0' && h2 <= '9') {
-		hp2 = h2 - '0';
-	} else if(h2 >= 'a' && h2 <= 'f') {
-		hp2 = h2 - 'a' + 10;
-	} else if(h2 >= 'A' && h2 <= 'F') {
-		hp2 = h2 - 'A' + 10;
-	}	
-	return (16 * hp1 + hp2);
 }
 
 void save(struct lexeme *tmpData, char to_save) {
-  char *holder = NULL;
-
-  if(length>=chunks*CHUNK) { //pokud je delka retezce vetsi nez alokovane
-    if(chunks)
-      holder = tmpData->value.string; //napln temp
-    if((tmpData->value.string = (char *)malloc(++chunks*CHUNK)) == NULL) //alokuj pamet
+  if(length >= string_size) { //pokud je delka retezce vetsi nez alokovane
+    string_size = (string_size) ? string_size * 2 : CHUNK; //zvetsovani bufferu
+    if((tmpData->value.string = (char *)gc_realloc(tmpData->value.string, string_size)) == NULL)
       throw_error(CODE_ERROR_INTERNAL, "malloc error");
-    if(holder) {
-      memcpy((void *)tmpData->value.string, (void *)holder, length); //kopiruj hodnotu retezce
-      free(holder); //uvolni tmp
-    }
   }
 
   tmpData->value.string[length++] = to_save; //ulozeni retezce
 }
 
-void save_temp(char to_save) {
-  if(temp_length >= CHUNK) //pokud neni alokovane misto
-    throw_error(CODE_ERROR_LEX, "identifier or number too long");
-  temp[temp_length++] = to_save; //ulozeni retezce
+const char *token_name(enum lex_type type) {
+  static const char *names[LEX_TYPE_COUNT] = {
+    [PLUS] = "+", [MINUS] = "-", [MULT] = "*", [DIVIDE] = "/",
+    [LT] = "<", [GT] = ">", [LTE] = "<=", [GTE] = ">=", [NEQ] = "!=", [EQ] = "==",
+    [LPAR] = "(", [RPAR] = ")", [IDENTIFIER] = "identifier", [NO_TYPE] = "none", [EQUALS] = "=",
+    [KW_AUTO] = "auto", [KW_CIN] = "cin", [KW_COUT] = "cout", [KW_DOUBLE] = "double",
+    [KW_ELSE] = "else", [KW_FOR] = "for", [KW_IF] = "if", [KW_INT] = "int",
+    [KW_RETURN] = "return", [KW_STRING] = "string",
+    [INTEGER] = "integer", [DOUBLE] = "double literal", [STRING] = "string literal",
+    [INSOP] = "<<", [EXTOP] = ">>", [LBR] = "{", [RBR] = "}",
+    [SEMICOLON] = ";", [COLON] = ",", [END_OF_FILE] = "end of file"
+  };
+  return ((unsigned)type < LEX_TYPE_COUNT && names[type]) ? names[type] : "?";
+}
+
+const char *lexeme_text(struct lexeme *tmpData) {
+  if(tmpData->type == IDENTIFIER)
+    return tmpData->value.symbol->str;
+  if(tmpData->value.string) //dekodovany retezec s escape sekvencemi
+    return tmpData->value.string;
+  return (const char *)input_start + tmpData->offset; //odkaz do zdrojoveho textu
 }
 
 void free_token(struct lexeme *tmpData) {
-  free(tmpData->value.string);  //uvolneni pameti
+  if(tmpData->type == STRING) //identifikatory patri tabulce nazvu
+    free(tmpData->value.string);  //uvolneni pameti
 }
@@ -8,24 +8,20 @@
 #include "input.h"
 #include "errors.h"
 #include "common.h"
+#include "intern.h"
+#include "number.h"
+#include "gc.h"
 
 #define CHUNK 256
 
-enum input_type {
-  LETTER,
-  DIGIT,
-  WHITE_SPACE,
-  UNDERSCORE,
-  END,
-  OTHERS
-};
-
-enum lex_type check_keyword(char *); //rozlyseni identifikatoru a kw
+void scanner_init(); //sestaveni tabulky trid znaku a prechodove tabulky, volat pred prvnim read_lexeme
+enum lex_type check_keyword(const char *, int); //rozlyseni identifikatoru a kw
 void read_input(); //nacteni znaku ze vstupu
 void return_input(); //vraceni znaku na vstup nacteneho navic pri ukonceni lexemu
 
 struct lexeme read_lexeme(void); // hlavni funkce
-unsigned char hexToInt(unsigned char *tmp);
+const char *token_name(enum lex_type); //nazev typu tokenu pro vypisy
+const char *lexeme_text(struct lexeme *); //text identifikatoru nebo retezce (delka v lexeme.length)
 
 void free_token(struct lexeme *); //uvolneni struktury lexemu
 
@@ -0,0 +1,65 @@
+#! /bin/bash
+
+# zatezovy test parseru vyrazu: jeden vyraz s N cleny (vychozi 25k, 50k, 100k),
+# cas musi rust linearne a vysledek musi sedet
+# pouziti: ./stress.sh [pocet clenu ...]
+# prepinace interpretu pres STRESS_FLAGS, napr. STRESS_FLAGS=--pratt ./stress.sh
+
+sizes=${@:-25000 50000 100000}
+
+stress_bin=$(mktemp)
+source_file=$(mktemp)
+trap "rm -f $stress_bin $source_file" EXIT
+
+gcc -std=c99 -O2 *.c -o $stress_bin -lm -lpthread &> /dev/null
+if [[ $? -ne 0 ]]; then
+    echo "cannot build the interpreter"
+    exit 1
+fi
+
+failed=0
+for terms in $sizes; do
+    for shape in chain nested; do
+        # chain:  x = 1 + 2 * 1 - 1 + 1 + 2 * 1 - 1 ...    (levy retezec)
+        # nested: x = 1 + (1 - 1 + (1 - 1 + (1 ...)))    (zavorky do hloubky)
+        awk -v terms=$terms -v shape=$shape 'BEGIN {
+            printf "int main() {\nint x;\nx = 1";
+            for (i = 1; i < terms; i++) {
+                if (shape == "chain") {
+                    printf "%s", (i % 3 == 1) ? " + 2 * 1" : ((i % 3 == 2) ? " - 1" : " + 1");
+                } else if (i % 2 == 1) {
+                    printf " + (1"; depth++;
+                } else {
+                    printf " - 1";
+                }
+            }
+            for (; depth > 0; depth--) printf ")";
+            printf ";\ncout << x;\nreturn 0;\n}\n";
+        }' > $source_file
+
+        if [[ $shape = "chain" ]]; then
+            expected=$(awk -v terms=$terms 'BEGIN {
+                x = 1;
+                for (i = 1; i < terms; i++) x += (i % 3 == 1) ? 2 : ((i % 3 == 2) ? -1 : 1);
+                printf "%d", x;
+            }')
+        else
+            # kazda zavorka je "1 - 1 + (vnitrek)", nejvnitrnejsi je "1" nebo "1 - 1"
+            expected=$(( terms % 2 == 0 ? 2 : 1 ))
+        fi
+
+        start=$(date +%s%N)
+        actual=$($stress_bin $STRESS_FLAGS $source_file)
+        result=$?
+        elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+
+        if [[ $result -ne 0 || "$actual" != "$expected" ]]; then
+            echo "$shape $terms terms: FAILED (exit $result, expected '$expected', got '$actual')"
+            ((failed++))
+        else
+            echo "$shape $terms terms: $elapsed ms"
+        fi
+    done
+done
+
+exit $failed
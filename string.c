@@ -1,8 +1,8 @@
 //jednoducha knihovna pro praci s nekonecne dlouhymi retezci
-// TODO: volame gc_realloc misto gc_malloc !!
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include "string.h"
 #include "gc.h"
 
@@ -38,6 +38,27 @@ string* new_str(char* txt)
 	return s;
 }
 
+// funkce vytvori novy retezec z len znaku txt, txt nemusi byt ukonceny '\0'
+// (napr. identifikator primo ve zdrojovem textu), alokuje se jen jednou
+string* new_str_len(const char* txt, int len)
+{
+	string* s = (string*)gc_malloc(sizeof(string));
+	if (!s) {
+		return NULL;
+	}
+
+	s->alloc_size = (len + 1 > STR_LEN_INC) ? len + 1 : STR_LEN_INC;
+	if ((s->str = (char*)gc_malloc(sizeof(char) * s->alloc_size)) == NULL) {
+		return NULL;
+	}
+
+	memcpy(s->str, txt, len);
+	s->str[len] = '\0';
+	s->len = len;
+
+	return s;
+}
+
 // funkce vymaze obsah retezce
 void clear_str(string*s) {
    s->str[0] = '\0';
@@ -56,8 +77,7 @@ string* cat_str(string* str1, string* str2) {
 int add_char(string* s, char c) {
    if (s->len + 1 >= s->alloc_size) {
       // pamet nestaci, je potreba provest realokaci
-      // TODO :: tady volame realloc
-      if ((s->str = (char*)realloc(s->str, (s->len + STR_LEN_INC) * sizeof(char))) == NULL)
+      if ((s->str = (char*)gc_realloc(s->str, (s->len + STR_LEN_INC) * sizeof(char))) == NULL)
          return false;
       s->alloc_size = s->len + STR_LEN_INC;
    }
@@ -86,6 +106,11 @@ int convert_chars(string* s, char* chs) {
 }
 
 int equals(string* s1, string* s2) {
+	if (s1 == s2) {
+		// stejny retezec (napr. nazvy z tabulky nazvu)
+		return true;
+	}
+
 	if(s1->len == s2->len) {
 		for(int i = 0; i < s1->len; i++) {
 			if(s1->str[i] != s2->str[i])
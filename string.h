@@ -10,6 +10,7 @@ typedef struct
 
 
 string* new_str(char* txt);
+string* new_str_len(const char* txt, int len);
 void clear_str(string* s);
 int concatenate(string* s1, string* s2);
 int add_char(string* s, char c);
@@ -9,6 +9,26 @@
 #include "string.h"
 #include <string.h>
 #include "symbol_table.h"
+#include "intern.h"
+#include "input.h"
+#include "number.h"
+#include "scanner.h"
+#include "pipeline.h"
+#include "arena.h"
+#include "ast.h"
+#include "flat.h"
+#include "parser.h"
+#include "cache.h"
+#include "parallel.h"
+#include "errors.h"
+#include "resolver.h"
+#include "interpret.h"
+#include "typecheck.h"
+#include "fold.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+extern __thread struct data* d; // aktualni data parseru (main.c)
 
 void TestString() {
 	string* str = new_str("hello");
@@ -19,18 +39,688 @@ void TestString() {
 void testHashTable() {
 	struct symbol_table * t = init_table();
 	scope_start(t, SCOPE_BLOCK);
-	set_symbol(t, new_str("a"), new_str("value_a"));
-	set_symbol(t, new_str("b"), new_str("value_b"));
-	string * val_a = get_symbol(t, new_str("a"));
-	string * val_b = get_symbol(t, new_str("b"));
+	set_symbol(t, intern_str("a"), new_str("value_a"));
+	set_symbol(t, intern_str("b"), new_str("value_b"));
+	string * val_a = get_symbol(t, intern_str("a"));
+	string * val_b = get_symbol(t, intern_str("b"));
 	assert(equals(val_a, new_str("value_a")));
 	scope_end(t);
 }
 
+void TestIntern() {
+	string* a = intern("abc", 3);
+	assert(a == intern_str("abc"));
+	assert(a != intern("ab", 2));
+	assert(strcmp(a->str, "abc") == 0);
+	// table growth keeps the identity
+	for (int i = 0; i < 5000; i++) {
+		char name[16];
+		sprintf(name, "n%d", i);
+		intern_str(name);
+	}
+	assert(a == intern("abcd", 3));
+}
+
+static void SetTestInput(const char* text) {
+	input_start = input_pos = (const unsigned char*)text;
+	input_end = input_start + strlen(text);
+}
+
+// zparsuje source do data, ktere se stanou aktualnimi (d)
+static struct data* ParseTestProgram(const char* source, struct data* data) {
+	d = data;
+	scanner_init();
+	SetTestInput(source);
+	parser_prepare(d);
+	parser_run();
+	assert(d->error == CODE_OK);
+	return data;
+}
+
+void TestInputSkip() {
+	// vector blocks plus the scalar tail
+	const char* ws = " \t\r\n                                        \n  x";
+	SetTestInput(ws);
+	skip_whitespace();
+	assert(*input_pos == 'x');
+
+	SetTestInput("// comment that is longer than thirty two bytes ......\nint");
+	skip_line();
+	assert(*input_pos == '\n' && input_pos[1] == 'i');
+
+	SetTestInput(" a * b ** c / d ................................. **/ end");
+	skip_block_comment();
+	assert(input_pos[0] == '*' && input_pos[1] == '/' && input_pos[-1] == '*');
+
+	// unterminated comment runs to the end of the input
+	SetTestInput(" never closed ................................... *");
+	skip_block_comment();
+	assert(input_pos == input_end);
+}
+
+static void CheckNumber(const char* txt) {
+	double expected = strtod(txt, NULL), got;
+	int len = (int)strlen(txt);
+	got = parse_double(txt, len);
+	assert(memcmp(&expected, &got, sizeof(double)) == 0);
+	if (strspn(txt, "0123456789") == (size_t)len)
+		assert(parse_int(txt, len) == atoi(txt));
+}
+
+void TestNumberParsing() {
+	const char* cases[] = {
+		"0", "7", "2147483647", "2147483648", "99999999999999999999999",
+		"0.0", "1.5", "0.1", "3.14159", "00012.0500", "1e10", "1E-5", "2e+22",
+		"9007199254740993", "9007199254740993.0", "1.7976931348623157e308",
+		"1e309", "4.9e-324", "1e-400", "123456789012345678901234.5", "0e99999",
+	};
+	char buffer[64];
+	unsigned i;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		CheckNumber(cases[i]);
+
+	// random literals in the shapes the scanner accepts
+	srand(15);
+	for (i = 0; i < 100000; i++) {
+		int n = sprintf(buffer, "%d", rand() % 100000000);
+		if (rand() % 2)
+			n += sprintf(buffer + n, ".%d", rand() % 1000000);
+		if (rand() % 2)
+			sprintf(buffer + n, "e%s%d", (rand() % 2) ? "-" : "", rand() % 40);
+		CheckNumber(buffer);
+	}
+}
+
+void TestPipeline() {
+	// longer than the queue, so the lexer thread has to wait for the consumer
+	static char source[64 * 1024];
+	static enum lex_type types[32 * 1024];
+	static int offsets[32 * 1024];
+	struct lexeme token;
+	int count = 0, len = 0;
+
+	while (len + 64 < (int)sizeof(source))
+		len += sprintf(source + len, "int x%d = 42 + 1.5e3; cout << \"a\\n\";\n", len);
+
+	scanner_init();
+	SetTestInput(source);
+	pipeline_start();
+	do {
+		token = pipeline_read_lexeme();
+		types[count] = token.type;
+		offsets[count++] = token.offset;
+		free_token(&token);
+	} while (token.type != END_OF_FILE);
+	pipeline_stop();
+
+	// the same stream as lexing on this thread
+	rewind_input();
+	for (int i = 0; i < count; i++) {
+		token = read_lexeme();
+		assert(token.type == types[i]);
+		assert(token.offset == offsets[i]);
+		free_token(&token);
+	}
+}
+
+void TestArena() {
+	struct arena a;
+	arena_init(&a, 1024);
+
+	// consecutive allocations are adjacent and aligned
+	char* first = arena_alloc(&a, 40);
+	char* second = arena_alloc(&a, 40);
+	assert(((uintptr_t)first & 15) == 0);
+	assert(second == first + 48);
+
+	// a large object gets its own block, small ones continue in the old one
+	char* big = arena_alloc(&a, 4096);
+	char* third = arena_alloc(&a, 8);
+	memset(big, 1, 4096);
+	assert(third == second + 48);
+	assert(a.used == 48 + 48 + 4096 + 16);
+
+	// reset keeps the current block and starts over at its beginning
+	arena_reset(&a);
+	assert(a.used == 0);
+	assert(arena_alloc(&a, 40) == first);
+
+	arena_release(&a);
+	assert(a.used == 0);
+	assert(arena_alloc(&a, 8) != NULL);
+	arena_release(&a);
+}
+
+void TestAstList() {
+	struct ast_list* list = ast_create_list();
+	struct ast_node* nodes[100];
+
+	assert(ast_list_at(list, 0) == NULL);
+	for (int i = 0; i < 100; i++) {
+		nodes[i] = ast_create_node();
+		ast_list_insert(list, nodes[i]);
+	}
+
+	// order is kept across the reallocations
+	assert(list->count == 100);
+	for (int i = 0; i < 100; i++) {
+		assert(list->elems[i] == nodes[i]);
+	}
+	assert(ast_list_at(list, 99) == nodes[99]);
+	assert(ast_list_at(list, 100) == NULL);
+
+	// leaves carry only the header, interior nodes add the children
+	char* leaf = (char*)ast_create_leaf();
+	char* next = (char*)ast_create_leaf();
+	char* interior = (char*)ast_create_node();
+	assert(AST_LEAF_SIZE == 16 && sizeof(struct ast_node) == AST_LEAF_SIZE + 2 * sizeof(struct ast_node*));
+	assert(next == leaf + AST_LEAF_SIZE && interior == next + AST_LEAF_SIZE);
+	assert(((struct ast_node*)leaf)->index == FLAT_NONE);
+}
+
+static struct ast_node* TestNode(enum ast_node_type type, struct ast_node* left, struct ast_node* right) {
+	struct ast_node* node = ast_create_node();
+	node->type = type;
+	node->left = left;
+	node->right = right;
+	return node;
+}
+
+void TestFlatAst() {
+	// (1 + x) * 2 wrapped in an expression node
+	struct ast_node* one = TestNode(AST_LITERAL, NULL, NULL);
+	struct ast_node* x = TestNode(AST_VAR, NULL, NULL);
+	struct ast_node* two = TestNode(AST_LITERAL, NULL, NULL);
+	struct ast_node* plus = TestNode(AST_BINARY_OP, one, x);
+	struct ast_node* times = TestNode(AST_BINARY_OP, plus, two);
+	struct ast_node* expr = TestNode(AST_EXPRESSION, times, NULL);
+	one->literal = two->literal = AST_LITERAL_INT;
+	one->d.numeric_data = 1;
+	two->d.numeric_data = 2;
+	x->d.string_data = intern_str("x");
+	plus->d.binary = AST_BINARY_PLUS;
+	times->d.binary = AST_BINARY_TIMES;
+
+	int32_t root = flat_convert(expr);
+	int32_t first = flat_first(root);
+
+	// postfix order: 1 x + 2 *
+	assert(root - first == 4);
+	assert(flat.kind[first] == FLAT_LITERAL && flat.value[first].numeric_data == 1);
+	assert(flat.kind[first + 1] == FLAT_VAR && flat.value[first + 1].string_data == intern_str("x"));
+	assert(flat.kind[first + 2] == FLAT_BINARY && flat.op[first + 2] == AST_BINARY_PLUS);
+	assert(flat.left[first + 2] == first && flat.right[first + 2] == first + 1);
+	assert(flat.kind[root] == FLAT_BINARY && flat.left[root] == first + 2 && flat.right[root] == first + 3);
+	flat_release();
+}
+
+static bool SameExpression(struct ast_node* a, struct ast_node* b) {
+	if (a == NULL || b == NULL)
+		return a == b;
+	if (a->type != b->type)
+		return false;
+
+	switch (a->type) {
+		case AST_BINARY_OP:
+			if (a->d.binary != b->d.binary)
+				return false;
+			break;
+		case AST_LITERAL:
+			if (a->literal != b->literal)
+				return false;
+			if (a->literal == AST_LITERAL_STRING)
+				return equals(a->d.string_data, b->d.string_data);
+			return a->d.numeric_data == b->d.numeric_data;
+		case AST_VAR:
+			return a->d.string_data == b->d.string_data;
+		case AST_CALL:
+			if (a->d.string_data != b->d.string_data || a->left->d.list->count != b->left->d.list->count)
+				return false;
+			for (int i = 0; i < a->left->d.list->count; i++) {
+				if (!SameExpression(ast_list_at(a->left->d.list, i), ast_list_at(b->left->d.list, i)))
+					return false;
+			}
+			return true;
+		default:
+			break;
+	}
+	return SameExpression(a->left, b->left) && SameExpression(a->right, b->right);
+}
+
+void TestPrattParser() {
+	struct data data = { .error = CODE_OK };
+	const char* cases[] = {
+		"a + 1 * b - c / 2.5;",
+		"1 - 2 - 3 < x * (y + z) == 0;",
+		"((a));",
+		"f(a, b * (c - 1), g()) + \"s\";",
+		"1 - (2 * (a + (b - f((c), (1))) / 3)) < 4;",
+		";",
+	};
+
+	d = &data;
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		struct ast_node* table = ast_create_node();
+		struct ast_node* pratt = ast_create_node();
+
+		SetTestInput(cases[i]);
+		get_token();
+		parser_use_pratt(false);
+		parse_expression(table);
+		assert(d->token->type == SEMICOLON);
+
+		rewind_input();
+		get_token();
+		parser_use_pratt(true);
+		parse_expression(pratt);
+		assert(d->token->type == SEMICOLON);
+
+		assert(table->type == AST_EXPRESSION && pratt->type == AST_EXPRESSION);
+		assert(SameExpression(table->left, pratt->left));
+	}
+
+	// parentheses nested deeper than the call stack would allow
+	const int depth = 200000;
+	static char deep[8 * 200000 + 8];
+	int length = 0;
+	for (int i = 0; i < depth; i++) {
+		length += sprintf(deep + length, "1 + (");
+	}
+	deep[length++] = '1';
+	memset(deep + length, ')', depth);
+	strcpy(deep + length + depth, ";");
+
+	struct ast_node* pratt = ast_create_node();
+	SetTestInput(deep);
+	get_token();
+	parse_expression(pratt);
+	assert(d->token->type == SEMICOLON);
+	struct ast_node* expr = pratt->left;
+	for (int i = 0; i < depth; i++) {
+		assert(expr->type == AST_BINARY_OP && expr->d.binary == AST_BINARY_PLUS);
+		expr = expr->right;
+	}
+	assert(expr->type == AST_LITERAL);
+	parser_use_pratt(false);
+}
+
+static char* ReadTestFile(const char* path, long* size) {
+	FILE* f = fopen(path, "rb");
+	assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	*size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* data = malloc(*size);
+	assert(fread(data, 1, *size, f) == (size_t)*size);
+	fclose(f);
+	return data;
+}
+
+void TestCache() {
+	struct data data = { .error = CODE_OK };
+	static char source[] = "int main() { int x = 1 + 2 * 3; if (x < 7) { cout << \"a\" << x; } else { } return 0; }";
+	const char* cache_file = "test_cache.ifj.ifjc";
+	long size, size_again;
+
+	ParseTestProgram(source, &data);
+	assert(cache_store("test_cache.ifj", d->tree));
+	char* stored = ReadTestFile(cache_file, &size);
+
+	// the loaded tree serializes to the same bytes
+	struct ast_node* loaded = cache_load("test_cache.ifj");
+	assert(loaded != NULL && loaded != d->tree);
+	assert(loaded->type == AST_FUNCTION_LIST && loaded->d.list->count == 1);
+	assert(cache_store("test_cache.ifj", loaded));
+	char* again = ReadTestFile(cache_file, &size_again);
+	assert(size == size_again && memcmp(stored, again, size) == 0);
+
+	// a changed source invalidates the cache
+	source[sizeof(source) - 2] = ' ';
+	assert(cache_load("test_cache.ifj") == NULL);
+	source[sizeof(source) - 2] = '}';
+
+	// so does a truncated file
+	FILE* f = fopen(cache_file, "wb");
+	fwrite(stored, 1, size - 1, f);
+	fclose(f);
+	assert(cache_load("test_cache.ifj") == NULL);
+
+	// and a tree of the wrong shape: node 1 (main) gets the root as its
+	// arguments (a cycle), then no arguments at all; offsets follow
+	// struct cache_header (40 bytes) and struct cache_node (20 bytes, left at 8)
+	int32_t arguments[] = { 0, -1 };
+	for (int i = 0; i < 2; i++) {
+		memcpy(again, stored, size);
+		memcpy(again + 40 + 20 + 8, &arguments[i], sizeof(int32_t));
+		f = fopen(cache_file, "wb");
+		fwrite(again, 1, size, f);
+		fclose(f);
+		assert(cache_load("test_cache.ifj") == NULL);
+	}
+
+	remove(cache_file);
+	free(stored);
+	free(again);
+}
+
+void TestLazyBody() {
+	struct data data = { .error = CODE_OK };
+	const char* source =
+		"int f(int a) { string s = \"}{\\\"}\"; /* } */ // }\n if (a < 1) { return 1; } else { } return a; }\n"
+		"int main() { return f(2); }";
+
+	parser_use_lazy(true);
+	ParseTestProgram(source, &data);
+	parser_use_lazy(false);
+
+	// both bodies skipped, braces in strings and comments are not counted
+	struct ast_list* functions = d->tree->d.list;
+	assert(functions->count == 2);
+	struct ast_node* body = ast_list_at(functions, 0)->right;
+	assert(body->type == AST_LAZY_BODY && ast_list_at(functions, 1)->right->type == AST_LAZY_BODY);
+	assert(source[body->d.offset] == '{');
+
+	assert(parser_parse_body(body));
+	assert(body->type == AST_BODY && body->d.list->count == 3);
+	assert(ast_list_at(body->d.list, 1)->type == AST_IF);
+
+	// a skipped body still goes through the lexer, its lexical error is reported
+	static struct error_trap trap;
+	struct data bad = { .error = CODE_OK };
+	d = &bad;
+	SetTestInput("int g(int a) { if (!a) { } else { } return 0; }\nint main() { return 0; }");
+	parser_use_lazy(true);
+	parser_prepare(d);
+	set_error_trap(&trap);
+	if (setjmp(trap.jump) == 0) {
+		parser_run();
+		assert(false);
+	}
+	set_error_trap(NULL);
+	parser_use_lazy(false);
+	assert(trap.type == CODE_ERROR_LEX);
+}
+
+void TestParallelParse() {
+	struct data sequential = { .error = CODE_OK };
+	struct data parallel = { .error = CODE_OK };
+	const int count = 3000;
+	char* source = malloc(count * 80 + 64);
+	int length = 0;
+
+	// dost funkci na nekolik kusu, zavorky v retezcich se pri deleni nepocitaji
+	for (int i = 0; i < count; i++) {
+		length += sprintf(source + length, "int f%d(int a) { string s = \"}{\"; return a * %d - (a + 1); }\n", i, i);
+	}
+	strcpy(source + length, "int main() { return f1(2); }");
+
+	ParseTestProgram(source, &sequential);
+
+	rewind_input();
+	assert(parallel_parse(&parallel, 4));
+	assert(input_pos == input_end);
+
+	struct ast_list* expected = sequential.tree->d.list;
+	struct ast_list* actual = parallel.tree->d.list;
+	assert(actual->count == count + 1 && expected->count == count + 1);
+	for (int i = 0; i <= count; i++) {
+		struct ast_node* a = ast_list_at(expected, i);
+		struct ast_node* b = ast_list_at(actual, i);
+		assert(a->type == AST_FUNCTION && b->type == AST_FUNCTION);
+		assert(a->d.string_data == b->d.string_data);
+		assert(a->right->d.list->count == b->right->d.list->count);
+		assert(SameExpression(ast_list_at(a->right->d.list, 1), ast_list_at(b->right->d.list, 1)));
+	}
+
+	// chyba v kterymkoli kusu: nic se nespoji a vstup je zpet na zacatku
+	memcpy(strstr(source + length / 2, "return"), "retur;", 6);
+	rewind_input();
+	parallel.error = CODE_OK;
+	assert(!parallel_parse(&parallel, 4));
+	assert(input_pos == input_start);
+	free(source);
+}
+
+void TestStreamBody() {
+	struct data data = { .error = CODE_OK };
+	const char* source =
+		"int f(int a) { string s = \"}\"; if (a < 1) { return 1; } else { } return a * (a - 1); }\n"
+		"int main() { return f(2); }";
+
+	long nodes = ast_node_count();
+	parser_use_stream(true);
+	ParseTestProgram(source, &data);
+
+	// bodies were checked and thrown away, only the headers stay
+	struct ast_list* functions = d->tree->d.list;
+	struct ast_node* body = ast_list_at(functions, 0)->right;
+	assert(body->type == AST_LAZY_BODY && source[body->d.offset] == '{');
+	assert(ast_node_count() - nodes == 1 + 3 + 1 + 3); // program, function, arguments, body (+ parameter a)
+	assert(parser_parse_body(body));
+	assert(body->type == AST_BODY && body->d.list->count == 3);
+
+	// unlike --lazy, a syntax error in a body is found while parsing
+	static struct error_trap trap;
+	data.error = CODE_OK;
+	SetTestInput("int f() { return 1 + ; }\nint main() { return 0; }");
+	set_error_trap(&trap);
+	if (setjmp(trap.jump) == 0) {
+		parser_prepare(d);
+		parser_run();
+		assert(d->error == CODE_ERROR_SYNTAX);
+	} else {
+		assert(trap.type == CODE_ERROR_SYNTAX);
+	}
+	set_error_trap(NULL);
+	ast_scratch_end();
+	parser_use_stream(false);
+}
+
+void TestResolver() {
+	struct data data = { .error = CODE_OK };
+	const char* source =
+		"int f(int a, int b) {\n"
+		"  int c = a + b;\n"
+		"  { int a = c; c = a; }\n"
+		"  for (int i = 0; i < c; i = i + 1) { int c = i; }\n"
+		"  int c;\n"
+		"  return nowhere;\n"
+		"}\n";
+
+	ParseTestProgram(source, &data);
+
+	struct ast_node* func = ast_list_at(d->tree->d.list, 0);
+	struct ast_list* body = func->right->d.list;
+	resolve_function(func);
+
+	// a, b, c, inner a, i, inner c
+	assert(func->index == 6);
+	struct ast_node* c = ast_list_at(body, 0);
+	assert(c->left->right->index == 2 && c->right->left->left->index == 0 && c->right->left->right->index == 1);
+
+	// the block sees its own a, the assignment after it the outer c
+	struct ast_list* block = ast_list_at(body, 1)->d.list;
+	assert(ast_list_at(block, 0)->left->right->index == 3);
+	assert(ast_list_at(block, 1)->left->index == 2 && ast_list_at(block, 1)->right->left->index == 3);
+
+	// loop header does not see the body, the body shadows c
+	struct ast_node* loop = ast_list_at(body, 2);
+	assert(ast_list_at(loop->d.list, 1)->left->right->index == 2);
+	assert(ast_list_at(loop->left->d.list, 0)->left->right->index == 5);
+
+	// errors are left for the interpreter
+	assert(ast_list_at(body, 3)->right->index == RESOLVE_REDEFINED);
+	assert(ast_list_at(body, 4)->left->left->index == RESOLVE_UNDEFINED);
+
+	// second call keeps the result
+	resolve_function(func);
+	assert(func->index == 6);
+}
+
+void TestCallBinding() {
+	struct data data = { .error = CODE_OK };
+	static struct error_trap trap;
+
+	ParseTestProgram("int g(int x) { return x; }\nint h() { return g(g(1)) + 1; }\nint k() { return missing(); }", &data);
+
+	struct ast_node* g = ast_list_at(d->tree->d.list, 0);
+	struct ast_node* h = ast_list_at(d->tree->d.list, 1);
+	struct ast_node* k = ast_list_at(d->tree->d.list, 2);
+	assert(resolve_add_function(g) && resolve_add_function(h) && resolve_add_function(k));
+	assert(!resolve_add_function(g));
+	assert(resolve_find_function(intern_str("h")) == h);
+	assert(resolve_find_function(intern_str("missing")) == NULL);
+
+	// both calls, the outer one and its argument, point at g
+	resolve_function(h);
+	struct ast_node* outer = ast_list_at(h->right->d.list, 0)->left->left->left;
+	assert(outer->type == AST_CALL && outer->right == g);
+	assert(ast_list_at(outer->left->d.list, 0)->left->right == g);
+
+	// an undefined function is reported while resolving, not when called
+	set_error_trap(&trap);
+	if (setjmp(trap.jump) == 0) {
+		resolve_function(k);
+		assert(false);
+	}
+	set_error_trap(NULL);
+	assert(trap.type == CODE_ERROR_SEMANTIC);
+}
+
+void TestBuiltinCalls() {
+	struct data data = { .error = CODE_OK };
+	static struct error_trap trap;
+
+	ParseTestProgram("int len() { return length(\"hello\") + find(\"hello\", \"l\"); }\nint bad() { return length(\"a\", \"b\"); }", &data);
+
+	struct ast_node* len = ast_list_at(d->tree->d.list, 0);
+	struct ast_node* bad = ast_list_at(d->tree->d.list, 1);
+
+	// builtins are registered with the functions, the call binds to one without body
+	struct ast_list only = { .elems = &len, .count = 1, .capacity = 1 };
+	InterpretInit(&only);
+	struct ast_node* expr = ast_list_at(len->right->d.list, 0)->left;
+	struct ast_node* call = expr->left->left;
+	assert(call->type == AST_CALL && call->right->right == NULL);
+	assert(call->right->d.string_data == intern_str("length"));
+
+	Variable* result = EvaluateExpression(expr);
+	assert(result->data_type == AST_VAR_INT && result->data.numeric_data == 7);
+
+	// the argument count is checked while binding, not when called
+	resolve_add_function(bad);
+	set_error_trap(&trap);
+	if (setjmp(trap.jump) == 0) {
+		resolve_function(bad);
+		assert(false);
+	}
+	set_error_trap(NULL);
+	assert(trap.type == CODE_ERROR_COMPATIBILITY);
+}
+
+void TestTypecheck() {
+	struct data data = { .error = CODE_OK };
+	static struct error_trap trap;
+
+	ParseTestProgram("double tc(double x) { auto y = x + 1; return y * 2; }\n"
+		"int tc_auto() { auto a; return 0; }\n"
+		"int tc_mix() { int a = 1 + 2.5; return a; }", &data);
+
+	struct ast_node* tc = ast_list_at(d->tree->d.list, 0);
+	struct ast_node* tc_auto = ast_list_at(d->tree->d.list, 1);
+	struct ast_node* tc_mix = ast_list_at(d->tree->d.list, 2);
+	assert(ast_list_at(tc->left->d.list, 0)->var_type == AST_VAR_DOUBLE);
+
+	// y is double through auto, both operations are checked before the run
+	resolve_function(tc);
+	typecheck_function(tc);
+	struct ast_node* plus = ast_list_at(tc->right->d.list, 0)->right->left;
+	struct ast_node* times = ast_list_at(tc->right->d.list, 1)->left->left;
+	assert(plus->type == AST_BINARY_OP && plus->literal == TYPECHECK_DONE && plus->var_type == AST_VAR_DOUBLE);
+	assert(times->type == AST_BINARY_OP && times->literal == TYPECHECK_DONE && times->var_type == AST_VAR_DOUBLE);
+
+	int32_t root = flat_convert(plus);
+	assert(flat.kind[root] == FLAT_BINARY && (flat.op[root] & FLAT_TYPED));
+
+	// auto without initialization and int + double are reported without running
+	struct ast_node* failing[] = { tc_auto, tc_mix };
+	ERROR_CODE expected[] = { CODE_ERROR_NO_AUTO, CODE_ERROR_COMPATIBILITY };
+	for (int i = 0; i < 2; i++) {
+		resolve_function(failing[i]);
+		set_error_trap(&trap);
+		if (setjmp(trap.jump) == 0) {
+			typecheck_function(failing[i]);
+			assert(false);
+		}
+		set_error_trap(NULL);
+		assert(trap.type == expected[i]);
+	}
+}
+
+void TestFolding() {
+	struct data data = { .error = CODE_OK };
+
+	ParseTestProgram("int fo() { int k = 2 + 3; string s = \"a\" + \"b\"; int m = 1; m = 2; return k * 2 + m + 1 / 0; }", &data);
+
+	struct ast_node* fo = ast_list_at(d->tree->d.list, 0);
+	resolve_function(fo);
+	typecheck_function(fo);
+	fold_function(fo);
+
+	struct ast_node* k = ast_list_at(fo->right->d.list, 0)->right->left;
+	assert(k->type == AST_LITERAL && k->literal == AST_LITERAL_INT && k->d.numeric_data == 5);
+	struct ast_node* s = ast_list_at(fo->right->d.list, 1)->right->left;
+	assert(s->type == AST_LITERAL && s->literal == AST_LITERAL_STRING && !strcmp(s->d.string_data->str, "ab"));
+
+	// k is constant, m is assigned again and 1 / 0 has to fail at run time
+	struct ast_node* sum = ast_list_at(fo->right->d.list, 4)->left->left;
+	struct ast_node* division = sum->right;
+	assert(sum->type == AST_BINARY_OP && division->type == AST_BINARY_OP);
+	assert(sum->left->type == AST_BINARY_OP && sum->left->right->type == AST_VAR);
+	struct ast_node* doubled = sum->left->left;
+	assert(doubled->type == AST_LITERAL && doubled->d.numeric_data == 10);
+
+	// 1 + (1 - 1 + (1 - 1 + ...)) nested deeper than the call stack would allow
+	const int depth = 200000;
+	static char deep[16 * 200000 + 64];
+	int length = sprintf(deep, "int deep() { return 1");
+	for (int i = 0; i < depth; i++) {
+		length += sprintf(deep + length, " + (1 - 1");
+	}
+	memset(deep + length, ')', depth);
+	strcpy(deep + length + depth, "; }");
+
+	struct data deep_data = { .error = CODE_OK };
+	struct ast_node* func = ast_list_at(ParseTestProgram(deep, &deep_data)->tree->d.list, 0);
+	resolve_function(func);
+	typecheck_function(func);
+	fold_function(func);
+	struct ast_node* folded = ast_list_at(func->right->d.list, 0)->left->left;
+	assert(folded->type == AST_LITERAL && folded->d.numeric_data == 1);
+}
+
 // Call only your testing funcitons in this function
 void StartUnitTests(){
 	// Add calls to testing functions here
 	TestString();
+	TestIntern();
+	TestInputSkip();
+	TestNumberParsing();
+	TestPipeline();
+	TestArena();
+	TestAstList();
+	TestFlatAst();
+	TestPrattParser();
+	TestCache();
+	TestLazyBody();
+	TestParallelParse();
+	TestStreamBody();
+	TestResolver();
+	TestCallBinding();
+	TestBuiltinCalls();
+	TestTypecheck();
+	TestFolding();
 	testHashTable();
 	printf("All tests were successfully executed!\n");
 }
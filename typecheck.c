@@ -0,0 +1,296 @@
+#include <stdlib.h>
+#include "typecheck.h"
+#include "interpret.h"
+#include "intern.h"
+#include "gc.h"
+#include "errors.h"
+
+#define TYPECHECK_INITIAL 64
+#define TYPE_UNKNOWN (-1) // typ se pozna az za behu
+
+// typ kazdeho slotu kontrolovane funkce (sloty viz resolver.h)
+static int* slot_types = NULL;
+static int slot_capacity = 0;
+
+// uzel vyrazu cekajici na zasobniku; expanded = operandy uz jsou nad nim
+struct type_frame {
+	struct ast_node* node;
+	bool expanded;
+};
+
+static struct type_frame* frames = NULL;
+static int frame_capacity = 0;
+static int* types = NULL;
+static int type_capacity = 0;
+
+static struct ast_node* function = NULL; // kontrolovana funkce
+static bool returns_checked = false; // navrat z main interpret nekontroluje
+
+static void* typecheck_grow(void* array, int* capacity, int needed, size_t item) {
+	while (*capacity < needed) {
+		*capacity = (*capacity) ? *capacity * 2 : TYPECHECK_INITIAL;
+	}
+	if (!(array = gc_realloc(array, (int)(*capacity * item)))) {
+		throw_error(CODE_ERROR_INTERNAL, "cannot allocate type check");
+	}
+	return array;
+}
+
+static int slot_type(int32_t slot) {
+	return (slot >= 0) ? slot_types[slot] : TYPE_UNKNOWN;
+}
+
+static bool compatible(int t1, int t2) {
+	return t1 == TYPE_UNKNOWN || t2 == TYPE_UNKNOWN || AreCompatibleTypes(t1, t2);
+}
+
+// typ vysledku podle EvaluateBinary* (rozhoduje typ leveho operandu),
+// operace, ktera za behu hlasi chybu 3, ma typ neznamy
+static int operation_type(enum ast_binary_op_type op, int left) {
+	bool arithmetic = op == AST_BINARY_PLUS || op == AST_BINARY_MINUS
+		|| op == AST_BINARY_TIMES || op == AST_BINARY_DIVIDE;
+	bool equality = op == AST_BINARY_EQUALS || op == AST_BINARY_NOT_EQUALS;
+
+	switch (left) {
+		case AST_VAR_INT:
+		case AST_VAR_DOUBLE:
+			return arithmetic ? left : AST_VAR_BOOL;
+		case AST_VAR_STRING:
+			if (op == AST_BINARY_PLUS) {
+				return AST_VAR_STRING;
+			}
+			return equality ? AST_VAR_INT : TYPE_UNKNOWN;
+		case AST_VAR_BOOL:
+			return equality ? AST_VAR_BOOL : TYPE_UNKNOWN;
+		case AST_VAR_NULL:
+			return AST_VAR_NULL;
+		default:
+			return TYPE_UNKNOWN;
+	}
+}
+
+static int binary_type(struct ast_node* node, int left, int right) {
+	if (left == TYPE_UNKNOWN || right == TYPE_UNKNOWN) {
+		return TYPE_UNKNOWN;
+	}
+	if (!AreCompatibleTypes(left, right)) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][Expression] Provided values are of different types");
+	}
+
+	int type = operation_type(node->d.binary, left);
+	if (type != TYPE_UNKNOWN) {
+		node->var_type = (uint8_t)type;
+		node->literal = TYPECHECK_DONE;
+	}
+	return type;
+}
+
+static void check_arity(struct ast_node* call) {
+	struct ast_node* func = call->right; // navazane resolverem
+	bool builtin = func->right == NULL;
+
+	if (!builtin && call->left->d.list->count > func->left->d.list->count) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Too many arguments in function call");
+	}
+}
+
+// args = typy argumentu volani v poradi
+static int call_type(struct ast_node* call, int* args) {
+	struct ast_node* func = call->right;
+	struct ast_list* params = func->left->d.list;
+	bool builtin = func->right == NULL;
+
+	for (int i = 0; i < call->left->d.list->count; i++) {
+		int param = params->elems[i]->var_type;
+
+		// vestavene funkce chteji presne svuj typ, parametr auto bere cokoliv
+		if (builtin && args[i] != TYPE_UNKNOWN && args[i] != param) {
+			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Invalid parameter type.");
+		}
+		if (!builtin && param != AST_VAR_AUTO && !compatible(param, args[i])) {
+			throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Argument of incompatible type");
+		}
+	}
+
+	return (func->var_type == AST_VAR_AUTO) ? TYPE_UNKNOWN : func->var_type;
+}
+
+static int leaf_type(struct ast_node* expr) {
+	if (expr == NULL) {
+		return TYPE_UNKNOWN;
+	}
+
+	switch (expr->type) {
+		case AST_LITERAL:
+			return GetVarTypeFromLiteral(expr->literal);
+		case AST_VAR:
+			return slot_type(expr->index);
+		default:
+			return TYPE_UNKNOWN;
+	}
+}
+
+static struct ast_node* unwrap(struct ast_node* expr) {
+	return (expr != NULL && expr->type == AST_EXPRESSION) ? expr->left : expr;
+}
+
+static int push_frame(int top, struct ast_node* node) {
+	if (top == frame_capacity) {
+		frames = typecheck_grow(frames, &frame_capacity, top + 1, sizeof(struct type_frame));
+	}
+	frames[top].node = unwrap(node);
+	frames[top].expanded = false;
+	return top + 1;
+}
+
+static int push_type(int top, int type) {
+	if (top == type_capacity) {
+		types = typecheck_grow(types, &type_capacity, top + 1, sizeof(int));
+	}
+	types[top] = type;
+	return top + 1;
+}
+
+// postorder s vlastnim zasobnikem (jako resolve_expression), hloubka
+// zavorek tak neomezuje zasobnik volani; typy operandu cekaji v types
+static int expression_type(struct ast_node* expr) {
+	int top = push_frame(0, expr);
+	int done = 0;
+
+	while (top > 0) {
+		struct type_frame* frame = &frames[top - 1];
+		struct ast_node* node = frame->node;
+
+		if (node != NULL && node->type == AST_BINARY_OP) {
+			if (!frame->expanded) {
+				frame->expanded = true;
+				top = push_frame(top, node->right);
+				top = push_frame(top, node->left);
+				continue;
+			}
+			done -= 2;
+			done = push_type(done, binary_type(node, types[done], types[done + 1]));
+		} else if (node != NULL && node->type == AST_CALL) {
+			struct ast_list* args = node->left->d.list;
+			if (!frame->expanded) {
+				frame->expanded = true;
+				check_arity(node);
+				for (int i = args->count - 1; i >= 0; i--) {
+					top = push_frame(top, args->elems[i]);
+				}
+				continue;
+			}
+			done -= args->count;
+			done = push_type(done, call_type(node, &types[done]));
+		} else {
+			done = push_type(done, leaf_type(node));
+		}
+		top--;
+	}
+
+	return types[0];
+}
+
+static void check_assignment(int target, int value) {
+	if (!compatible(target, value)) {
+		throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret] Assigning bad value to the variable");
+	}
+}
+
+// deklarace dostane typ; auto typ hodnoty, ktera se do ni prirazuje
+static int declare(struct ast_node* creation, int value) {
+	int type = creation->left->var_type;
+	if (creation->right->index < 0) {
+		return TYPE_UNKNOWN; // redefinice, chyba 3 az za behu
+	}
+	if (type == AST_VAR_AUTO) {
+		type = value;
+	}
+	slot_types[creation->right->index] = type;
+	return type;
+}
+
+static void check_list(struct ast_list* list);
+
+static void check_statement(struct ast_node* node) {
+	switch (node->type) {
+		case AST_ASSIGN: {
+			int value = expression_type(node->right);
+			if (node->left->type == AST_VAR_CREATION) {
+				check_assignment(declare(node->left, value), value);
+			} else {
+				check_assignment(slot_type(node->left->index), value);
+			}
+			break;
+		}
+		case AST_VAR_CREATION:
+			if (node->left->var_type == AST_VAR_AUTO) {
+				throw_error(CODE_ERROR_NO_AUTO, "[Interpret] Type of auto variable cannot be inferred without initialization");
+			}
+			declare(node, TYPE_UNKNOWN);
+			break;
+		case AST_EXPRESSION:
+		case AST_CALL:
+			expression_type(node);
+			break;
+		case AST_RETURN: {
+			int value = expression_type(node->left);
+			if (returns_checked && value != TYPE_UNKNOWN && !AreCompatibleTypes(function->var_type, value)) {
+				throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][Return] Cannot return non-compatible values");
+			}
+			break;
+		}
+		case AST_IF:
+			if (!compatible(expression_type(node->d.condition), AST_VAR_BOOL)) {
+				throw_error(CODE_ERROR_COMPATIBILITY, "[Interpret][If] Expression not bool");
+			}
+			check_list(node->left->d.list);
+			check_list(node->right->d.list);
+			break;
+		case AST_FOR:
+			// podminka, ktera neni bool, je za behu chyba 3, ta tu neni
+			check_statement(node->d.list->elems[0]);
+			expression_type(node->d.list->elems[1]);
+			check_statement(node->d.list->elems[2]);
+			check_list(node->left->d.list);
+			break;
+		case AST_BLOCK:
+			check_list(node->d.list);
+			break;
+		case AST_COUT:
+			for (int i = 0; i < node->d.list->count; i++) {
+				expression_type(node->d.list->elems[i]);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void check_list(struct ast_list* list) {
+	for (int i = 0; i < list->count; i++) {
+		check_statement(list->elems[i]);
+	}
+}
+
+void typecheck_function(struct ast_node* func) {
+	struct ast_list* params = func->left->d.list;
+
+	if (slot_capacity < func->index) {
+		slot_types = typecheck_grow(slot_types, &slot_capacity, func->index, sizeof(int));
+	}
+	for (int32_t i = 0; i < func->index; i++) {
+		slot_types[i] = TYPE_UNKNOWN;
+	}
+	// parametr auto bere typ argumentu, ten se pozna az za behu
+	for (int i = 0; i < params->count; i++) {
+		struct ast_node* param = params->elems[i];
+		if (param->index >= 0 && param->var_type != AST_VAR_AUTO) {
+			slot_types[param->index] = param->var_type;
+		}
+	}
+
+	function = func;
+	returns_checked = func->d.string_data != intern_str("main");
+	check_list(func->right->d.list);
+}
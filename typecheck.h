@@ -0,0 +1,24 @@
+#ifndef TYPECHECK_H
+#define TYPECHECK_H
+
+#include "ast.h"
+
+// Staticka kontrola typu rozlisene funkce (resolver.h), pred jejim behem.
+// Typy se odvozuji podle stejnych pravidel jako za behu (AreCompatibleTypes
+// a vysledky operaci v interpretu): promenna ma deklarovany typ, auto typ
+// sve inicializace, parametr deklarovany typ a volani navratovy typ funkce.
+// Chyba, ktera by za behu nastala pri kazdem provedeni, se hlasi hned
+// (4 nekompatibilni typy, 5 auto bez inicializace). Kde typ znamy neni
+// (nedeklarovana promenna, operace hlasici chybu 3), zustava kontrola
+// na interpretu.
+//
+// Binarni operace, jejichz typy operandu kontrola overila, maji
+// literal = TYPECHECK_DONE a ve var_type typ vysledku; interpret u nich
+// kompatibilitu operandu znovu nekontroluje (viz FLAT_TYPED).
+
+#define TYPECHECK_DONE 1
+
+// telo uz musi byt rozlisene; volat jednou, hned po resolve_function
+void typecheck_function(struct ast_node* func);
+
+#endif